@@ -39,13 +39,29 @@
 #include "gpk-dialog.h"
 #include "gpk-enum.h"
 #include "gpk-error.h"
+#include "gpk-catalog.h"
+#include "gpk-package-model.h"
+#include "gpk-results.h"
+#include "gpk-trigram-index.h"
 #include "gpk-task.h"
 #include "gpk-debug.h"
 
+#define GPK_APPLICATION_SEARCH_CACHE_SIZE	16 /* searches */
+#define GPK_APPLICATION_DETAILS_CACHE_SIZE	500 /* packages */
+#define GPK_APPLICATION_DETAILS_BATCH_SIZE	50 /* packages */
+#define GPK_APPLICATION_DETAILS_PREFETCH_DELAY	150 /* ms */
+#define GPK_APPLICATION_REQUEST_DELAY		50 /* ms */
+#define GPK_APPLICATION_STARTUP_CACHE_VERSION	1
+#define GPK_APPLICATION_STARTUP_CACHE_DELAY	10 /* s */
+#define GPK_APPLICATION_GROUP_PREFETCH_DELAY	3 /* s */
+#define GPK_APPLICATION_GROUP_PREFETCH_MAX	3 /* groups */
+#define GPK_APPLICATION_HISTORY_SIZE		8 /* result lists */
+
 typedef enum {
 	GPK_SEARCH_NAME,
 	GPK_SEARCH_DETAILS,
 	GPK_SEARCH_FILE,
+	GPK_SEARCH_ALL,
 	GPK_SEARCH_UNKNOWN
 } GpkSearchType;
 
@@ -64,33 +80,156 @@ typedef enum {
 	GPK_ACTION_UNKNOWN
 } GpkActionMode;
 
+/* selection-driven work, in the order it is sent to the daemon */
+typedef enum {
+	GPK_APPLICATION_REQUEST_DETAILS,
+	GPK_APPLICATION_REQUEST_FILES,
+	GPK_APPLICATION_REQUEST_REQUIRES,
+	GPK_APPLICATION_REQUEST_DEPENDS,
+	GPK_APPLICATION_REQUEST_PREFETCH,
+	GPK_APPLICATION_REQUEST_GROUP_PREFETCH,
+	GPK_APPLICATION_REQUEST_CATALOG,
+	GPK_APPLICATION_REQUEST_LAST
+} GpkApplicationRequestKind;
+
+/* a small least-recently-used cache of string keys to owned values */
+typedef struct {
+	const gchar		*name;
+	GHashTable		*hash;		/* key to GList link in queue */
+	GQueue			*queue;		/* of GpkApplicationCacheItem, newest first */
+	GDestroyNotify		 value_destroy;
+	guint			 size_max;
+	guint			 hits;
+	guint			 misses;
+} GpkApplicationCache;
+
+typedef struct {
+	gchar			*key;
+	gpointer		 value;
+} GpkApplicationCacheItem;
+
+/* a finished result list, kept so going back to it needs no transaction */
+typedef struct {
+	GpkSearchMode		 search_mode;
+	gchar			*search_group;
+	gchar			*search_text;
+	GpkPackageModel		*model;		/* only set when in the history */
+	GHashTable		*package_ids;
+	GtkTreePath		*selected;
+	GtkTreePath		*top;		/* the first visible row */
+} GpkApplicationHistoryItem;
+
+/* owned by the worker thread until it returns */
+typedef struct {
+	GPtrArray		*packages;
+	gchar			**terms;
+	GArray			*ranked;	/* of GpkResultsItem, best first */
+	gdouble			 elapsed;	/* ms */
+} GpkApplicationRankJob;
+
+/* a list waiting for the catalog write before it to finish */
+typedef struct {
+	gchar			*key;
+	GPtrArray		*packages;
+} GpkApplicationCatalogSave;
+
 typedef struct {
 	gboolean		 has_package;
 	gboolean		 search_in_progress;
+	gboolean		 results_finished;
 	GCancellable		*cancellable;
 	gchar			*homepage_url;
 	gchar			*search_group;
 	gchar			*search_text;
+	gchar			*search_key;
+	GCancellable		*search_cancellable;
+	guint			 search_delay_id;
+	guint			 search_generation;
+	guint			 search_pending;	/* transactions still running */
+	gboolean		 search_failed;
+	gboolean		 search_succeeded;
+	GPtrArray		*search_results;	/* from all of them, for the cache */
+	gchar			**search_terms;	/* lower case, for ranking */
+	gboolean		 search_refined;
+	gboolean		 results_from_catalog;	/* shown before the daemon replied */
+	gchar			*refine_text;
+	PkBitfield		 refine_filters;
+	GpkApplicationCache	*search_cache;
+	GpkApplicationCache	*details_cache;	/* package-id to PkDetails */
+	GpkCatalog		*catalog;	/* the lists from last time, on disk */
+	GQueue			*catalog_saves;	/* of GpkApplicationCatalogSave */
+	gboolean		 catalog_saving;
+	GpkTrigramIndex		*catalog_index;	/* for suggesting what was meant */
+	gboolean		 catalog_building;
+	GHashTable		*details_pending;	/* package-id to the request fetching it */
+	gchar			*details_package_id;	/* what the details pane wants */
+	guint			 details_prefetch_id;
+	GQueue			*requests_queued;	/* of GpkApplicationRequest, by kind */
+	GPtrArray		*requests_running;
+	guint			 requests_id;
+	GHashTable		*group_usage;	/* group-id to times selected */
+	guint			 group_prefetch_id;
+	GQueue			*history_back;	/* of GpkApplicationHistoryItem, newest first */
+	GQueue			*history_forward;
+	GpkApplicationHistoryItem *history_current;	/* what the finished list is showing */
 	GHashTable		*repos;
+	GHashTable		*results_package_ids;
+	GPtrArray		*results_pending;	/* not ranked yet */
+	GpkApplicationRankJob	*results_ranking;	/* in the worker thread */
+	GArray			*results_ranked;	/* of GpkResultsItem */
+	guint			 results_id;
 	GpkActionMode		 action;
+	GpkActionMode		 action_shown;	/* what the checkboxes were drawn for */
 	GpkSearchMode		 search_mode;
 	GpkSearchType		 search_type;
 	GtkApplication		*application;
 	GSettings		*settings;
 	GtkBuilder		*builder;
-	GtkListStore		*packages_store;
+	GpkPackageModel		*packages_store;
 	GtkTreeStore		*groups_store;
 	guint			 details_event_id;
 	guint			 status_id;
 	PkBitfield		 filters_current;
 	PkBitfield		 groups;
 	PkBitfield		 roles;
+	PkBitfield		 filters;
+	gboolean		 properties_valid;	/* from the daemon, not the cache */
+	gboolean		 properties_shown;
+	GPtrArray		*categories;
+	gboolean		 categories_requested;
+	gchar			*startup_cache_data;	/* as last loaded or saved */
+	guint			 startup_cache_save_id;
 	PkControl		*control;
 	PkPackageSack		*package_sack;
+	GHashTable		*package_sack_ids;	/* the package-ids in package_sack */
 	PkStatusEnum		 status_last;
 	PkTask			*task;
 } GpkApplicationPrivate;
 
+typedef struct {
+	GpkApplicationPrivate	*priv;
+	gchar			**terms;	/* keep packages whose name has all of these */
+	GHashTable		*ids;		/* or keep packages with these package-ids */
+} GpkApplicationRefineHelper;
+
+/* one per transaction started by the request scheduler */
+typedef struct {
+	GpkApplicationPrivate	*priv;
+	GpkApplicationRequestKind kind;
+	gchar			**package_ids;
+	gchar			*group;		/* for GROUP_PREFETCH */
+	gchar			*search_key;	/* where the group results are saved */
+	GCancellable		*cancellable;
+} GpkApplicationRequest;
+
+/* one per search transaction, so late results from an old query can be ignored */
+typedef struct {
+	GpkApplicationPrivate	*priv;
+	GCancellable		*cancellable;
+	guint			 generation;
+	gboolean		 show_errors;
+} GpkApplicationSearchHelper;
+
 enum {
 	GPK_STATE_INSTALLED,
 	GPK_STATE_IN_LIST,
@@ -98,17 +237,6 @@ enum {
 	GPK_STATE_UNKNOWN
 };
 
-enum {
-	PACKAGES_COLUMN_IMAGE,
-	PACKAGES_COLUMN_STATE,  /* state of the item */
-	PACKAGES_COLUMN_CHECKBOX,  /* what we show in the checkbox */
-	PACKAGES_COLUMN_CHECKBOX_VISIBLE, /* visible */
-	PACKAGES_COLUMN_TEXT,
-	PACKAGES_COLUMN_ID,
-	PACKAGES_COLUMN_SUMMARY,
-	PACKAGES_COLUMN_LAST
-};
-
 enum {
 	GROUPS_COLUMN_ICON,
 	GROUPS_COLUMN_NAME,
@@ -119,9 +247,20 @@ enum {
 };
 
 static void gpk_application_perform_search (GpkApplicationPrivate *priv);
-
-static void gpk_application_get_requires_cb (PkClient *client, GAsyncResult *res, GpkApplicationPrivate *priv);
-static void gpk_application_get_depends_cb (PkClient *client, GAsyncResult *res, GpkApplicationPrivate *priv);
+static void gpk_application_add_item_to_results (GpkApplicationPrivate *priv, PkPackage *item);
+static void gpk_application_details_prefetch (GpkApplicationPrivate *priv);
+static void gpk_application_groups_prefetch_schedule (GpkApplicationPrivate *priv);
+static void gpk_application_requests_schedule (GpkApplicationPrivate *priv, guint delay);
+static void gpk_application_requests_add (GpkApplicationPrivate *priv, GpkApplicationRequestKind kind, gchar **package_ids);
+static void gpk_application_requests_cancel (GpkApplicationPrivate *priv, GpkApplicationRequestKind kind);
+static void gpk_application_apply_properties (GpkApplicationPrivate *priv);
+static void gpk_application_startup_cache_save (GpkApplicationPrivate *priv);
+static void gpk_application_startup_cache_save_schedule (GpkApplicationPrivate *priv);
+
+static void gpk_application_get_requires_cb (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request_data);
+static void gpk_application_get_depends_cb (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request_data);
+static void gpk_application_group_prefetch_cb (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request_data);
+static void gpk_application_catalog_cb (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request_data);
 
 static gboolean
 _g_strzero (const gchar *text)
@@ -133,6 +272,292 @@ _g_strzero (const gchar *text)
 	return FALSE;
 }
 
+static const gchar *
+_g_strnull_to_empty (const gchar *text)
+{
+	return text != NULL ? text : "";
+}
+
+/* the queue is only changed through these, so the package-id index stays correct */
+static void
+gpk_application_queue_add (GpkApplicationPrivate *priv, PkPackage *package)
+{
+	pk_package_sack_add_package (priv->package_sack, package);
+	g_hash_table_add (priv->package_sack_ids, g_strdup (pk_package_get_id (package)));
+}
+
+static gboolean
+gpk_application_queue_remove (GpkApplicationPrivate *priv, const gchar *package_id)
+{
+	if (!pk_package_sack_remove_package_by_id (priv->package_sack, package_id))
+		return FALSE;
+	g_hash_table_remove (priv->package_sack_ids, package_id);
+	return TRUE;
+}
+
+static gboolean
+gpk_application_queue_contains (GpkApplicationPrivate *priv, const gchar *package_id)
+{
+	return g_hash_table_contains (priv->package_sack_ids, package_id);
+}
+
+static void
+gpk_application_queue_clear (GpkApplicationPrivate *priv)
+{
+	pk_package_sack_clear (priv->package_sack);
+	g_hash_table_remove_all (priv->package_sack_ids);
+}
+
+static GpkApplicationCache *
+gpk_application_cache_new (const gchar *name, guint size_max, GDestroyNotify value_destroy)
+{
+	GpkApplicationCache *cache = g_new0 (GpkApplicationCache, 1);
+	cache->name = name;
+	cache->hash = g_hash_table_new (g_str_hash, g_str_equal);
+	cache->queue = g_queue_new ();
+	cache->value_destroy = value_destroy;
+	cache->size_max = size_max;
+	return cache;
+}
+
+static void
+gpk_application_cache_item_free (GpkApplicationCache *cache, GpkApplicationCacheItem *item)
+{
+	if (cache->value_destroy != NULL)
+		cache->value_destroy (item->value);
+	g_free (item->key);
+	g_free (item);
+}
+
+static void
+gpk_application_cache_clear (GpkApplicationCache *cache)
+{
+	GpkApplicationCacheItem *item;
+
+	g_debug ("%s cache cleared, %u items", cache->name, g_queue_get_length (cache->queue));
+	g_hash_table_remove_all (cache->hash);
+	while ((item = g_queue_pop_head (cache->queue)) != NULL)
+		gpk_application_cache_item_free (cache, item);
+}
+
+static void
+gpk_application_cache_free (GpkApplicationCache *cache)
+{
+	gpk_application_cache_clear (cache);
+	g_hash_table_unref (cache->hash);
+	g_queue_free (cache->queue);
+	g_free (cache);
+}
+
+/* returns a value owned by the cache, or NULL */
+static gpointer
+gpk_application_cache_lookup (GpkApplicationCache *cache, const gchar *key)
+{
+	GList *link;
+
+	link = g_hash_table_lookup (cache->hash, key);
+	if (link == NULL) {
+		cache->misses++;
+		g_debug ("%s cache miss for '%s' (%u hits, %u misses)",
+			 cache->name, key, cache->hits, cache->misses);
+		return NULL;
+	}
+	cache->hits++;
+	g_debug ("%s cache hit for '%s' (%u hits, %u misses)",
+		 cache->name, key, cache->hits, cache->misses);
+
+	/* move to the front */
+	g_queue_unlink (cache->queue, link);
+	g_queue_push_head_link (cache->queue, link);
+	return ((GpkApplicationCacheItem *) link->data)->value;
+}
+
+/* like lookup, but does not count towards the statistics or the age */
+static gboolean
+gpk_application_cache_contains (GpkApplicationCache *cache, const gchar *key)
+{
+	return g_hash_table_contains (cache->hash, key);
+}
+
+/* takes ownership of value */
+static void
+gpk_application_cache_insert (GpkApplicationCache *cache, const gchar *key, gpointer value)
+{
+	GList *link;
+	GpkApplicationCacheItem *item;
+
+	/* replace any old value */
+	link = g_hash_table_lookup (cache->hash, key);
+	if (link != NULL) {
+		item = link->data;
+		g_hash_table_remove (cache->hash, item->key);
+		g_queue_delete_link (cache->queue, link);
+		gpk_application_cache_item_free (cache, item);
+	}
+
+	/* drop the least recently used */
+	while (g_queue_get_length (cache->queue) >= cache->size_max) {
+		item = g_queue_pop_tail (cache->queue);
+		g_hash_table_remove (cache->hash, item->key);
+		gpk_application_cache_item_free (cache, item);
+	}
+
+	item = g_new0 (GpkApplicationCacheItem, 1);
+	item->key = g_strdup (key);
+	item->value = value;
+	g_queue_push_head (cache->queue, item);
+	g_hash_table_insert (cache->hash, item->key, cache->queue->head);
+}
+
+static void
+gpk_application_catalog_save_free (GpkApplicationCatalogSave *save)
+{
+	g_ptr_array_unref (save->packages);
+	g_free (save->key);
+	g_free (save);
+}
+
+static void gpk_application_catalog_save_next (GpkApplicationPrivate *priv);
+
+static void
+gpk_application_catalog_save_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	GpkApplicationPrivate *priv = (GpkApplicationPrivate *) user_data;
+	g_autoptr(GError) error = NULL;
+
+	priv->catalog_saving = FALSE;
+	if (!gpk_catalog_set_finish (GPK_CATALOG (source), res, &error))
+		g_warning ("failed to save catalog: %s", error->message);
+	gpk_application_catalog_save_next (priv);
+}
+
+/* each write starts from the file the last one mapped, so only one runs */
+static void
+gpk_application_catalog_save_next (GpkApplicationPrivate *priv)
+{
+	GpkApplicationCatalogSave *save;
+
+	if (priv->catalog_saving)
+		return;
+	save = g_queue_pop_head (priv->catalog_saves);
+	if (save == NULL)
+		return;
+	g_debug ("saving %u packages to the catalog for %s", save->packages->len, save->key);
+	priv->catalog_saving = TRUE;
+	gpk_catalog_set_async (priv->catalog, save->key, save->packages, NULL,
+			       gpk_application_catalog_save_cb, priv);
+	gpk_application_catalog_save_free (save);
+}
+
+/* so the list can be shown at once next time, even if the daemon is busy */
+static void
+gpk_application_catalog_save (GpkApplicationPrivate *priv, const gchar *key, GPtrArray *array)
+{
+	GpkApplicationCatalogSave *save;
+	GList *l;
+
+	if (key == NULL)
+		return;
+
+	/* only the newest list for each key is worth writing */
+	for (l = priv->catalog_saves->head; l != NULL; l = l->next) {
+		save = l->data;
+		if (g_strcmp0 (save->key, key) != 0)
+			continue;
+		g_ptr_array_unref (save->packages);
+		save->packages = g_ptr_array_ref (array);
+		return;
+	}
+	save = g_new0 (GpkApplicationCatalogSave, 1);
+	save->key = g_strdup (key);
+	save->packages = g_ptr_array_ref (array);
+	g_queue_push_tail (priv->catalog_saves, save);
+	gpk_application_catalog_save_next (priv);
+}
+
+static const gchar *
+gpk_application_request_kind_to_string (GpkApplicationRequestKind kind)
+{
+	switch (kind) {
+	case GPK_APPLICATION_REQUEST_DETAILS:
+		return "details";
+	case GPK_APPLICATION_REQUEST_FILES:
+		return "files";
+	case GPK_APPLICATION_REQUEST_REQUIRES:
+		return "requires";
+	case GPK_APPLICATION_REQUEST_DEPENDS:
+		return "depends";
+	case GPK_APPLICATION_REQUEST_PREFETCH:
+		return "prefetch";
+	case GPK_APPLICATION_REQUEST_GROUP_PREFETCH:
+		return "group-prefetch";
+	case GPK_APPLICATION_REQUEST_CATALOG:
+		return "catalog";
+	default:
+		return "unknown";
+	}
+}
+
+static GpkApplicationRequest *
+gpk_application_request_new (GpkApplicationPrivate *priv,
+			     GpkApplicationRequestKind kind,
+			     gchar **package_ids)
+{
+	GpkApplicationRequest *request = g_new0 (GpkApplicationRequest, 1);
+	request->priv = priv;
+	request->kind = kind;
+	request->package_ids = g_strdupv (package_ids);
+	request->cancellable = g_cancellable_new ();
+	return request;
+}
+
+/* lets other requests ask for the details this one was fetching */
+static void
+gpk_application_request_release (GpkApplicationRequest *request)
+{
+	GHashTable *pending = request->priv->details_pending;
+	guint i;
+
+	if (request->package_ids == NULL)
+		return;
+	for (i = 0; request->package_ids[i] != NULL; i++) {
+		if (g_hash_table_lookup (pending, request->package_ids[i]) == request)
+			g_hash_table_remove (pending, request->package_ids[i]);
+	}
+}
+
+static void
+gpk_application_request_free (GpkApplicationRequest *request)
+{
+	gpk_application_request_release (request);
+	g_object_unref (request->cancellable);
+	g_strfreev (request->package_ids);
+	g_free (request->group);
+	g_free (request->search_key);
+	g_free (request);
+}
+
+static void
+gpk_application_request_cancel (GpkApplicationRequest *request)
+{
+	g_debug ("cancelling %s request", gpk_application_request_kind_to_string (request->kind));
+	g_cancellable_cancel (request->cancellable);
+	gpk_application_request_release (request);
+}
+
+/* the transaction is done, so anything waiting behind it can be sent */
+static void
+gpk_application_request_finished (GpkApplicationRequest *request)
+{
+	GpkApplicationPrivate *priv = request->priv;
+
+	g_ptr_array_remove (priv->requests_running, request);
+	if (priv->requests_id == 0 && !g_queue_is_empty (priv->requests_queued))
+		gpk_application_requests_schedule (priv, 0);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GpkApplicationRequest, gpk_application_request_free)
+
 static const gchar *
 gpk_application_state_get_icon (PkBitfield state)
 {
@@ -183,7 +608,9 @@ static void
 gpk_application_set_text_buffer (GtkWidget *widget, const gchar *text)
 {
 	GtkTextBuffer *buffer;
-	buffer = gtk_text_buffer_new (NULL);
+
+	/* reuse the buffer the view already has */
+	buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (widget));
 	/* ITS4: ignore, not used for allocation */
 	if (_g_strzero (text) == FALSE) {
 		gtk_text_buffer_set_text (buffer, text, -1);
@@ -191,7 +618,6 @@ gpk_application_set_text_buffer (GtkWidget *widget, const gchar *text)
 		/* no information */
 		gtk_text_buffer_set_text (buffer, "", -1);
 	}
-	gtk_text_view_set_buffer (GTK_TEXT_VIEW (widget), buffer);
 }
 
 static void
@@ -231,19 +657,15 @@ gpk_application_packages_checkbox_invert (GpkApplicationPrivate *priv)
 	}
 
 	gtk_tree_model_get (model, &iter,
-			    PACKAGES_COLUMN_STATE, &state,
-			    PACKAGES_COLUMN_ID, &package_id,
+			    GPK_PACKAGE_MODEL_COLUMN_STATE, &state,
+			    GPK_PACKAGE_MODEL_COLUMN_ID, &package_id,
 			    -1);
 
 	/* do something with the value */
 	pk_bitfield_invert (state, GPK_STATE_IN_LIST);
 
 	/* set new value */
-	gtk_list_store_set (GTK_LIST_STORE (model), &iter,
-			    PACKAGES_COLUMN_STATE, state,
-			    PACKAGES_COLUMN_CHECKBOX, gpk_application_state_get_checkbox (state),
-			    PACKAGES_COLUMN_IMAGE, gpk_application_state_get_icon (state),
-			    -1);
+	gpk_package_model_set_state (GPK_PACKAGE_MODEL (model), &iter, state);
 }
 
 static gboolean
@@ -283,12 +705,12 @@ gpk_application_get_selected_package (GpkApplicationPrivate *priv, gchar **packa
 	/* get data */
 	if (summary == NULL) {
 		gtk_tree_model_get (model, &iter,
-				    PACKAGES_COLUMN_ID, package_id,
+				    GPK_PACKAGE_MODEL_COLUMN_ID, package_id,
 				    -1);
 	} else {
 		gtk_tree_model_get (model, &iter,
-				    PACKAGES_COLUMN_ID, package_id,
-				    PACKAGES_COLUMN_SUMMARY, summary,
+				    GPK_PACKAGE_MODEL_COLUMN_ID, package_id,
+				    GPK_PACKAGE_MODEL_COLUMN_SUMMARY, summary,
 				    -1);
 	}
 	return TRUE;
@@ -338,16 +760,42 @@ gpk_application_group_remove_selected (GpkApplicationPrivate *priv)
 	gtk_tree_store_remove (priv->groups_store, &iter);
 }
 
+static void
+gpk_application_refresh_checkbox_visible (GpkApplicationPrivate *priv)
+{
+	GtkTreeView *treeview;
+	GtkTreePath *start;
+	GtkTreePath *end;
+	gboolean installed_changed;
+	gboolean available_changed;
+	PkBitfield mask = 0;
+	PkBitfield value = 0;
+
+	if (priv->action_shown == priv->action)
+		return;
+
+	/* installing hides the checkbox on installed rows, removing on the others */
+	installed_changed = (priv->action_shown == GPK_ACTION_INSTALL) != (priv->action == GPK_ACTION_INSTALL);
+	available_changed = (priv->action_shown == GPK_ACTION_REMOVE) != (priv->action == GPK_ACTION_REMOVE);
+	priv->action_shown = priv->action;
+	if (!installed_changed || !available_changed) {
+		mask = pk_bitfield_value (GPK_STATE_INSTALLED);
+		value = installed_changed ? mask : 0;
+	}
+
+	/* rows that are not on screen are worked out when they are drawn */
+	treeview = GTK_TREE_VIEW (gtk_builder_get_object (priv->builder, "treeview_packages"));
+	if (!gtk_tree_view_get_visible_range (treeview, &start, &end))
+		return;
+	gpk_package_model_refresh (priv->packages_store, start, end, mask, value);
+	gtk_tree_path_free (start);
+	gtk_tree_path_free (end);
+}
+
 static void
 gpk_application_change_queue_status (GpkApplicationPrivate *priv)
 {
 	GtkWidget *widget;
-	GtkTreeView *treeview;
-	gboolean valid;
-	GtkTreeIter iter;
-	GtkTreeModel *model;
-	PkBitfield state;
-	gboolean enabled;
 
 	/* show and hide the action widgets */
 	if (pk_package_sack_get_size (priv->package_sack) > 0) {
@@ -365,30 +813,8 @@ gpk_application_change_queue_status (GpkApplicationPrivate *priv)
 		gpk_application_group_remove_selected (priv);
 	}
 
-	/* correct the enabled state */
-	treeview = GTK_TREE_VIEW (gtk_builder_get_object (priv->builder, "treeview_packages"));
-	model = gtk_tree_view_get_model (treeview);
-	valid = gtk_tree_model_get_iter_first (model, &iter);
-
-	/* for all current items, reset the state if in the array */
-	while (valid) {
-		g_autofree gchar *package_id = NULL;
-		gtk_tree_model_get (model, &iter,
-				    PACKAGES_COLUMN_STATE, &state,
-				    PACKAGES_COLUMN_ID, &package_id,
-				    -1);
-
-		/* we never show the checkbox for the search helper */
-		if (package_id == NULL) {
-			enabled = FALSE;
-		} else {
-			enabled = gpk_application_get_checkbox_enable (priv, state);
-		}
-
-		/* set visible */
-		gtk_list_store_set (GTK_LIST_STORE (model), &iter, PACKAGES_COLUMN_CHECKBOX_VISIBLE, enabled, -1);
-		valid = gtk_tree_model_iter_next (model, &iter);
-	}
+	/* the enabled state depends on the action */
+	gpk_application_refresh_checkbox_visible (priv);
 }
 
 static gboolean
@@ -408,7 +834,7 @@ gpk_application_install (GpkApplicationPrivate *priv)
 
 	/* changed mind, or wrong mode */
 	if (priv->action == GPK_ACTION_REMOVE) {
-		ret = pk_package_sack_remove_package_by_id (priv->package_sack, package_id_selected);
+		ret = gpk_application_queue_remove (priv, package_id_selected);
 		if (ret) {
 			g_debug ("removed %s from package array", package_id_selected);
 
@@ -425,8 +851,7 @@ gpk_application_install (GpkApplicationPrivate *priv)
 	}
 
 	/* already added */
-	package = pk_package_sack_find_by_id (priv->package_sack, package_id_selected);
-	if (package != NULL) {
+	if (gpk_application_queue_contains (priv, package_id_selected)) {
 		g_warning ("already added");
 		goto out;
 	}
@@ -441,7 +866,7 @@ gpk_application_install (GpkApplicationPrivate *priv)
 		      "info", PK_INFO_ENUM_AVAILABLE,
 		      "summary", summary_selected,
 		      NULL);
-	pk_package_sack_add_package (priv->package_sack, package);
+	gpk_application_queue_add (priv, package);
 
 	/* correct buttons */
 	gpk_application_allow_install (priv, FALSE);
@@ -459,15 +884,10 @@ gpk_application_menu_homepage_cb (GtkAction *action, GpkApplicationPrivate *priv
 	gtk_show_uri (NULL, priv->homepage_url, GDK_CURRENT_TIME, NULL);
 }
 
-static gint
-gpk_application_strcmp_indirect (gchar **a, gchar **b)
-{
-	return strcmp (*a, *b);
-}
-
 static void
-gpk_application_get_files_cb (PkClient *client, GAsyncResult *res, GpkApplicationPrivate *priv)
+gpk_application_get_files_process (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request)
 {
+	GpkApplicationPrivate *priv = request->priv;
 	gboolean ret;
 	g_auto(GStrv) files = NULL;
 	g_autofree gchar *package_id_selected = NULL;
@@ -475,7 +895,7 @@ gpk_application_get_files_cb (PkClient *client, GAsyncResult *res, GpkApplicatio
 	g_autofree gchar *title = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GPtrArray) array = NULL;
-	g_autoptr(GPtrArray) array_sort = NULL;
+	guint len;
 	GtkWidget *dialog;
 	GtkWindow *window;
 	g_autoptr(PkError) error_code = NULL;
@@ -485,6 +905,10 @@ gpk_application_get_files_cb (PkClient *client, GAsyncResult *res, GpkApplicatio
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
 	if (results == NULL) {
+		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+			g_debug ("%s request superseded", gpk_application_request_kind_to_string (request->kind));
+			return;
+		}
 		g_warning ("failed to get files: %s", error->message);
 		return;
 	}
@@ -523,21 +947,20 @@ gpk_application_get_files_cb (PkClient *client, GAsyncResult *res, GpkApplicatio
 		      "files", &files,
 		      NULL);
 
-	/* convert to pointer array */
-	array_sort = pk_strv_to_ptr_array (files);
-	g_ptr_array_sort (array_sort, (GCompareFunc) gpk_application_strcmp_indirect);
+	/* sorted by the dialog in a thread */
+	len = files != NULL ? g_strv_length (files) : 0;
 
 	/* title */
 	split = pk_package_id_split (package_id_selected);
 	/* TRANSLATORS: title: how many files are installed by the application */
 	title = g_strdup_printf (ngettext ("%u file installed by %s",
 					   "%u files installed by %s",
-					   array_sort->len), array_sort->len, split[PK_PACKAGE_ID_NAME]);
+					   len), len, split[PK_PACKAGE_ID_NAME]);
 
 	window = GTK_WINDOW (gtk_builder_get_object (priv->builder, "window_manager"));
 	dialog = gtk_message_dialog_new (window, GTK_DIALOG_DESTROY_WITH_PARENT,
 					 GTK_MESSAGE_INFO, GTK_BUTTONS_OK, "%s", title);
-	gpk_dialog_embed_file_list_widget (GTK_DIALOG (dialog), array_sort);
+	gpk_dialog_embed_file_list_widget (GTK_DIALOG (dialog), g_steal_pointer (&files));
 	gtk_window_set_resizable (GTK_WINDOW (dialog), TRUE);
 	gtk_window_set_default_size (GTK_WINDOW (dialog), 600, 250);
 
@@ -545,6 +968,14 @@ gpk_application_get_files_cb (PkClient *client, GAsyncResult *res, GpkApplicatio
 	gtk_widget_destroy (GTK_WIDGET (dialog));
 }
 
+static void
+gpk_application_get_files_cb (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request_data)
+{
+	g_autoptr(GpkApplicationRequest) request = request_data;
+	gpk_application_get_files_process (client, res, request);
+	gpk_application_request_finished (request);
+}
+
 static gboolean
 gpk_application_status_changed_timeout_cb (GpkApplicationPrivate *priv)
 {
@@ -641,6 +1072,28 @@ gpk_application_progress_cb (PkProgress *progress, PkProgressType type, GpkAppli
 	}
 }
 
+static void
+gpk_application_search_progress_cb (PkProgress *progress, PkProgressType type, GpkApplicationSearchHelper *helper)
+{
+	GpkApplicationPrivate *priv = helper->priv;
+	g_autoptr(PkPackage) package = NULL;
+
+	/* the user has already asked for something else */
+	if (helper->generation != priv->search_generation)
+		return;
+
+	/* show each result as the daemon emits it, not when finished */
+	if (type == PK_PROGRESS_TYPE_PACKAGE) {
+		g_object_get (progress,
+			      "package", &package,
+			      NULL);
+		if (package != NULL)
+			gpk_application_add_item_to_results (priv, package);
+		return;
+	}
+	gpk_application_progress_cb (progress, type, priv);
+}
+
 static void
 gpk_application_menu_files_cb (GtkAction *action, GpkApplicationPrivate *priv)
 {
@@ -655,14 +1108,9 @@ gpk_application_menu_files_cb (GtkAction *action, GpkApplicationPrivate *priv)
 		return;
 	}
 
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
-
 	/* set correct view */
 	package_ids = pk_package_ids_from_id (package_id_selected);
-	pk_client_get_files_async (PK_CLIENT (priv->task), package_ids, priv->cancellable,
-				   (PkProgressCallback) gpk_application_progress_cb, priv,
-				   (GAsyncReadyCallback) gpk_application_get_files_cb, priv);
+	gpk_application_requests_add (priv, GPK_APPLICATION_REQUEST_FILES, package_ids);
 }
 
 static gboolean
@@ -682,7 +1130,7 @@ gpk_application_remove (GpkApplicationPrivate *priv)
 
 	/* changed mind, or wrong mode */
 	if (priv->action == GPK_ACTION_INSTALL) {
-		ret = pk_package_sack_remove_package_by_id (priv->package_sack, package_id_selected);
+		ret = gpk_application_queue_remove (priv, package_id_selected);
 		if (ret) {
 			g_debug ("removed %s from package array", package_id_selected);
 
@@ -699,7 +1147,7 @@ gpk_application_remove (GpkApplicationPrivate *priv)
 	}
 
 	/* already added */
-	ret = (pk_package_sack_find_by_id (priv->package_sack, package_id_selected) == NULL);
+	ret = !gpk_application_queue_contains (priv, package_id_selected);
 	if (!ret) {
 		g_warning ("already added");
 		goto out;
@@ -712,7 +1160,7 @@ gpk_application_remove (GpkApplicationPrivate *priv)
 		      "info", PK_INFO_ENUM_INSTALLED,
 		      "summary", summary_selected,
 		      NULL);
-	pk_package_sack_add_package (priv->package_sack, package);
+	gpk_application_queue_add (priv, package);
 
 	/* correct buttons */
 	gpk_application_allow_install (priv, TRUE);
@@ -737,8 +1185,9 @@ gpk_application_menu_remove_cb (GtkAction *action, GpkApplicationPrivate *priv)
 }
 
 static void
-gpk_application_get_requires_cb (PkClient *client, GAsyncResult *res, GpkApplicationPrivate *priv)
+gpk_application_get_requires_process (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request)
 {
+	GpkApplicationPrivate *priv = request->priv;
 	g_autoptr(PkResults) results = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(PkError) error_code = NULL;
@@ -755,6 +1204,10 @@ gpk_application_get_requires_cb (PkClient *client, GAsyncResult *res, GpkApplica
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
 	if (results == NULL) {
+		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+			g_debug ("%s request superseded", gpk_application_request_kind_to_string (request->kind));
+			return;
+		}
 		g_warning ("failed to get requires: %s", error->message);
 		return;
 	}
@@ -816,6 +1269,14 @@ gpk_application_get_requires_cb (PkClient *client, GAsyncResult *res, GpkApplica
 	gtk_widget_destroy (GTK_WIDGET (dialog));
 }
 
+static void
+gpk_application_get_requires_cb (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request_data)
+{
+	g_autoptr(GpkApplicationRequest) request = request_data;
+	gpk_application_get_requires_process (client, res, request);
+	gpk_application_request_finished (request);
+}
+
 static void
 gpk_application_menu_requires_cb (GtkAction *action, GpkApplicationPrivate *priv)
 {
@@ -830,22 +1291,15 @@ gpk_application_menu_requires_cb (GtkAction *action, GpkApplicationPrivate *priv
 		return;
 	}
 
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
-
 	/* get the requires */
 	package_ids = pk_package_ids_from_id (package_id_selected);
-
-	pk_client_depends_on_async (PK_CLIENT (priv->task),
-				    pk_bitfield_value (PK_FILTER_ENUM_NONE),
-				    package_ids, TRUE, priv->cancellable,
-				    (PkProgressCallback) gpk_application_progress_cb, priv,
-				    (GAsyncReadyCallback) gpk_application_get_depends_cb, priv);
+	gpk_application_requests_add (priv, GPK_APPLICATION_REQUEST_REQUIRES, package_ids);
 }
 
 static void
-gpk_application_get_depends_cb (PkClient *client, GAsyncResult *res, GpkApplicationPrivate *priv)
+gpk_application_get_depends_process (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request)
 {
+	GpkApplicationPrivate *priv = request->priv;
 	g_autoptr(PkResults) results = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(PkError) error_code = NULL;
@@ -862,6 +1316,10 @@ gpk_application_get_depends_cb (PkClient *client, GAsyncResult *res, GpkApplicat
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
 	if (results == NULL) {
+		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+			g_debug ("%s request superseded", gpk_application_request_kind_to_string (request->kind));
+			return;
+		}
 		g_warning ("failed to get depends: %s", error->message);
 		return;
 	}
@@ -923,6 +1381,14 @@ gpk_application_get_depends_cb (PkClient *client, GAsyncResult *res, GpkApplicat
 	gtk_widget_destroy (GTK_WIDGET (dialog));
 }
 
+static void
+gpk_application_get_depends_cb (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request_data)
+{
+	g_autoptr(GpkApplicationRequest) request = request_data;
+	gpk_application_get_depends_process (client, res, request);
+	gpk_application_request_finished (request);
+}
+
 static void
 gpk_application_menu_depends_cb (GtkAction *_action, GpkApplicationPrivate *priv)
 {
@@ -937,17 +1403,9 @@ gpk_application_menu_depends_cb (GtkAction *_action, GpkApplicationPrivate *priv
 		return;
 	}
 
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
-
 	/* get the depends */
 	package_ids = pk_package_ids_from_id (package_id_selected);
-
-	pk_client_required_by_async (PK_CLIENT (priv->task),
-				     pk_bitfield_value (PK_FILTER_ENUM_NONE),
-				     package_ids, TRUE, priv->cancellable,
-				     (PkProgressCallback) gpk_application_progress_cb, priv,
-				     (GAsyncReadyCallback) gpk_application_get_requires_cb, priv);
+	gpk_application_requests_add (priv, GPK_APPLICATION_REQUEST_DEPENDS, package_ids);
 }
 
 static const gchar *
@@ -1001,77 +1459,497 @@ gpk_application_clear_details (GpkApplicationPrivate *priv)
 				 "[GpkApplication] clear-details");
 }
 
-static void
-gpk_application_clear_packages (GpkApplicationPrivate *priv)
-{
-	/* clear existing array */
-	priv->has_package = FALSE;
-	gtk_list_store_clear (priv->packages_store);
-}
+static void gpk_application_results_finished (GpkApplicationPrivate *priv);
 
 static void
-gpk_application_add_item_to_results (GpkApplicationPrivate *priv, PkPackage *item)
+gpk_application_package_model_func (GpkPackageModel *model,
+				    PkPackage *package,
+				    PkBitfield state,
+				    GpkPackageModelColumn column,
+				    GValue *value,
+				    gpointer user_data)
 {
-	GtkTreeIter iter;
-	g_autofree gchar *text = NULL;
-	gboolean in_queue;
-	gboolean installed;
-	gboolean enabled;
-	PkBitfield state = 0;
-	static guint package_cnt = 0;
-	PkInfoEnum info;
-	g_autofree gchar *package_id = NULL;
-	g_autofree gchar *summary = NULL;
+	GpkApplicationPrivate *priv = (GpkApplicationPrivate *) user_data;
 	GtkWidget *widget;
 
-	/* get data */
-	g_object_get (item,
-		      "info", &info,
-		      "package-id", &package_id,
-		      "summary", &summary,
-		      NULL);
+	switch (column) {
+	case GPK_PACKAGE_MODEL_COLUMN_IMAGE:
+		g_value_set_static_string (value, gpk_application_state_get_icon (state));
+		break;
+	case GPK_PACKAGE_MODEL_COLUMN_CHECKBOX:
+		g_value_set_boolean (value, gpk_application_state_get_checkbox (state));
+		break;
+	case GPK_PACKAGE_MODEL_COLUMN_CHECKBOX_VISIBLE:
+		/* can we modify this? */
+		g_value_set_boolean (value, gpk_application_get_checkbox_enable (priv, state));
+		break;
+	case GPK_PACKAGE_MODEL_COLUMN_TEXT:
+		/* use two lines */
+		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "window_manager"));
+		g_value_take_string (value, gpk_package_id_format_twoline (gtk_widget_get_style_context (widget),
+									   pk_package_get_id (package),
+									   pk_package_get_summary (package)));
+		break;
+	default:
+		break;
+	}
+}
 
-	/* mark as got so we don't warn */
-	priv->has_package = TRUE;
+/* the backend knows its own version ordering, so it picks the newest
+ * packages when it can; the model only does this as a fallback */
+static gboolean
+gpk_application_backend_has_newest (GpkApplicationPrivate *priv)
+{
+	return pk_bitfield_contain (priv->filters, PK_FILTER_ENUM_NEWEST);
+}
 
-	/* are we in the package array? */
-	in_queue = (pk_package_sack_find_by_id (priv->package_sack, package_id) != NULL);
-	installed = (info == PK_INFO_ENUM_INSTALLED) || (info == PK_INFO_ENUM_COLLECTION_INSTALLED);
+/* the arch filter is applied by the package model, so the same results
+ * can be shown again with and without it */
+static PkBitfield
+gpk_application_get_backend_filters (GpkApplicationPrivate *priv)
+{
+	PkBitfield filters = priv->filters_current;
+	if (!gpk_application_backend_has_newest (priv))
+		pk_bitfield_remove (filters, PK_FILTER_ENUM_NEWEST);
+	pk_bitfield_remove (filters, PK_FILTER_ENUM_ARCH);
+	return filters;
+}
 
-	if (installed)
-		pk_bitfield_add (state, GPK_STATE_INSTALLED);
-	if (in_queue)
-		pk_bitfield_add (state, GPK_STATE_IN_LIST);
+/* whatever the backend did not apply */
+static PkBitfield
+gpk_application_get_model_filters (GpkApplicationPrivate *priv)
+{
+	PkBitfield filters = priv->filters_current;
+	if (gpk_application_backend_has_newest (priv))
+		pk_bitfield_remove (filters, PK_FILTER_ENUM_NEWEST);
+	return filters;
+}
 
-	/* special icon */
-	if (info == PK_INFO_ENUM_COLLECTION_INSTALLED || info == PK_INFO_ENUM_COLLECTION_AVAILABLE)
-		pk_bitfield_add (state, GPK_STATE_COLLECTION);
+static GpkPackageModel *
+gpk_application_packages_store_new (GpkApplicationPrivate *priv)
+{
+	GpkPackageModel *store = gpk_package_model_new ();
+	gpk_package_model_set_func (store, gpk_application_package_model_func, priv);
+	gpk_package_model_set_filters (store, gpk_application_get_model_filters (priv));
+	return store;
+}
 
-	/* use two lines */
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "window_manager"));
-	text = gpk_package_id_format_twoline (gtk_widget_get_style_context (widget),
-					      package_id,
-					      summary);
-
-	/* can we modify this? */
-	enabled = gpk_application_get_checkbox_enable (priv, state);
-
-	gtk_list_store_append (priv->packages_store, &iter);
-	gtk_list_store_set (priv->packages_store, &iter,
-			    PACKAGES_COLUMN_STATE, state,
-			    PACKAGES_COLUMN_CHECKBOX, gpk_application_state_get_checkbox (state),
-			    PACKAGES_COLUMN_CHECKBOX_VISIBLE, enabled,
-			    PACKAGES_COLUMN_TEXT, text,
-			    PACKAGES_COLUMN_SUMMARY, summary,
-			    PACKAGES_COLUMN_ID, package_id,
-			    PACKAGES_COLUMN_IMAGE, gpk_application_state_get_icon (state),
-			    -1);
+/* shows the results we already have with the new filters */
+static void
+gpk_application_results_refilter (GpkApplicationPrivate *priv)
+{
+	GtkTreeView *treeview;
+	GtkTreeSelection *selection;
+	GtkTreeModel *model;
+	GtkTreeIter iter;
+	GtkTreePath *path;
+	g_autofree gchar *package_id = NULL;
+
+	treeview = GTK_TREE_VIEW (gtk_builder_get_object (priv->builder, "treeview_packages"));
+	selection = gtk_tree_view_get_selection (treeview);
+	if (gtk_tree_selection_get_selected (selection, &model, &iter))
+		gtk_tree_model_get (model, &iter, GPK_PACKAGE_MODEL_COLUMN_ID, &package_id, -1);
+
+	/* only the rows that appear or disappear are signalled */
+	gpk_package_model_set_filters (priv->packages_store, gpk_application_get_model_filters (priv));
+
+	/* keep the same package selected, if it is still shown */
+	if (package_id != NULL &&
+	    gpk_package_model_find_id (priv->packages_store, package_id, &iter)) {
+		gtk_tree_selection_select_iter (selection, &iter);
+		path = gtk_tree_model_get_path (GTK_TREE_MODEL (priv->packages_store), &iter);
+		gtk_tree_view_scroll_to_cell (treeview, path, NULL, TRUE, 0.5f, 0.f);
+		gtk_tree_path_free (path);
+	}
+	gpk_application_details_prefetch (priv);
+}
+
+static void
+gpk_application_history_item_free (GpkApplicationHistoryItem *item)
+{
+	g_free (item->search_group);
+	g_free (item->search_text);
+	if (item->model != NULL)
+		g_object_unref (item->model);
+	if (item->package_ids != NULL)
+		g_hash_table_unref (item->package_ids);
+	if (item->selected != NULL)
+		gtk_tree_path_free (item->selected);
+	if (item->top != NULL)
+		gtk_tree_path_free (item->top);
+	g_free (item);
+}
+
+static void
+gpk_application_history_update_actions (GpkApplicationPrivate *priv)
+{
+	GAction *action;
+
+	action = g_action_map_lookup_action (G_ACTION_MAP (priv->application), "back");
+	g_simple_action_set_enabled (G_SIMPLE_ACTION (action),
+				     !g_queue_is_empty (priv->history_back));
+	action = g_action_map_lookup_action (G_ACTION_MAP (priv->application), "forward");
+	g_simple_action_set_enabled (G_SIMPLE_ACTION (action),
+				     !g_queue_is_empty (priv->history_forward));
+}
+
+/* only keep so many models alive, dropping the ones furthest away first */
+static void
+gpk_application_history_trim (GpkApplicationPrivate *priv)
+{
+	GpkApplicationHistoryItem *item;
+	GQueue *queue;
+
+	while (priv->history_back->length + priv->history_forward->length > GPK_APPLICATION_HISTORY_SIZE) {
+		if (priv->history_back->length >= priv->history_forward->length)
+			queue = priv->history_back;
+		else
+			queue = priv->history_forward;
+		item = g_queue_pop_tail (queue);
+		gpk_application_history_item_free (item);
+	}
+	gpk_application_history_update_actions (priv);
+}
+
+/* forget every list, as the package states in them may be wrong */
+static void
+gpk_application_history_clear (GpkApplicationPrivate *priv)
+{
+	g_queue_foreach (priv->history_back, (GFunc) gpk_application_history_item_free, NULL);
+	g_queue_clear (priv->history_back);
+	g_queue_foreach (priv->history_forward, (GFunc) gpk_application_history_item_free, NULL);
+	g_queue_clear (priv->history_forward);
+	g_clear_pointer (&priv->history_current,
+			 (GDestroyNotify) gpk_application_history_item_free);
+	gpk_application_history_update_actions (priv);
+}
+
+/* remember what the finished list is showing */
+static void
+gpk_application_history_set_current (GpkApplicationPrivate *priv)
+{
+	GpkApplicationHistoryItem *item;
+
+	g_clear_pointer (&priv->history_current,
+			 (GDestroyNotify) gpk_application_history_item_free);
+	if (!priv->has_package)
+		return;
+	if (priv->search_mode != GPK_MODE_NAME_DETAILS_FILE &&
+	    priv->search_mode != GPK_MODE_GROUP &&
+	    priv->search_mode != GPK_MODE_ALL_PACKAGES)
+		return;
+
+	item = g_new0 (GpkApplicationHistoryItem, 1);
+	item->search_mode = priv->search_mode;
+	item->search_group = g_strdup (priv->search_group);
+	item->search_text = g_strdup (priv->search_text);
+	priv->history_current = item;
+}
+
+/* takes the shown list out of the view, leaving an empty one in its place */
+static GpkApplicationHistoryItem *
+gpk_application_history_take (GpkApplicationPrivate *priv)
+{
+	GpkApplicationHistoryItem *item = priv->history_current;
+	GtkTreeView *treeview;
+	GtkTreeSelection *selection;
+	GtkTreeModel *model;
+	GtkTreeIter iter;
+	gint sort_column;
+	GtkSortType sort_order;
+
+	if (item == NULL)
+		return NULL;
+	priv->history_current = NULL;
+
+	treeview = GTK_TREE_VIEW (gtk_builder_get_object (priv->builder, "treeview_packages"));
+	selection = gtk_tree_view_get_selection (treeview);
+	if (gtk_tree_selection_get_selected (selection, &model, &iter))
+		item->selected = gtk_tree_model_get_path (model, &iter);
+	gtk_tree_view_get_visible_range (treeview, &item->top, NULL);
+
+	/* the new list is sorted like the old one */
+	item->model = priv->packages_store;
+	item->package_ids = priv->results_package_ids;
+	gtk_tree_sortable_get_sort_column_id (GTK_TREE_SORTABLE (item->model),
+					      &sort_column, &sort_order);
+	priv->packages_store = gpk_application_packages_store_new (priv);
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (priv->packages_store),
+					      sort_column, sort_order);
+	priv->results_package_ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+	gtk_tree_view_set_model (treeview, GTK_TREE_MODEL (priv->packages_store));
+	return item;
+}
+
+static void
+gpk_application_results_stop (GpkApplicationPrivate *priv)
+{
+	/* stop adding the old results */
+	if (priv->results_id > 0) {
+		g_source_remove (priv->results_id);
+		priv->results_id = 0;
+	}
+	g_ptr_array_set_size (priv->results_pending, 0);
+	g_array_set_size (priv->results_ranked, 0);
+	priv->results_ranking = NULL;
+	priv->results_finished = FALSE;
+	priv->search_refined = FALSE;
+	priv->results_from_catalog = FALSE;
+	g_clear_pointer (&priv->refine_text, g_free);
+}
+
+static void
+gpk_application_clear_packages (GpkApplicationPrivate *priv)
+{
+	GpkApplicationHistoryItem *item;
+
+	gpk_application_results_stop (priv);
+
+	/* a finished list is kept to go back to, anything else is cleared */
+	priv->has_package = FALSE;
+	item = gpk_application_history_take (priv);
+	if (item != NULL) {
+		g_queue_push_head (priv->history_back, item);
+		g_queue_foreach (priv->history_forward, (GFunc) gpk_application_history_item_free, NULL);
+		g_queue_clear (priv->history_forward);
+		gpk_application_history_trim (priv);
+	} else {
+		g_hash_table_remove_all (priv->results_package_ids);
+		gpk_package_model_clear (priv->packages_store);
+	}
+}
+
+static PkBitfield
+gpk_application_get_item_state (GpkApplicationPrivate *priv, PkPackage *item)
+{
+	gboolean in_queue;
+	gboolean installed;
+	PkBitfield state = 0;
+	PkInfoEnum info;
+
+	info = pk_package_get_info (item);
+
+	/* are we in the package array? */
+	in_queue = gpk_application_queue_contains (priv, pk_package_get_id (item));
+	installed = (info == PK_INFO_ENUM_INSTALLED) || (info == PK_INFO_ENUM_COLLECTION_INSTALLED);
+
+	if (installed)
+		pk_bitfield_add (state, GPK_STATE_INSTALLED);
+	if (in_queue)
+		pk_bitfield_add (state, GPK_STATE_IN_LIST);
+
+	/* special icon */
+	if (info == PK_INFO_ENUM_COLLECTION_INSTALLED || info == PK_INFO_ENUM_COLLECTION_AVAILABLE)
+		pk_bitfield_add (state, GPK_STATE_COLLECTION);
+	return state;
+}
+
+static void
+gpk_application_insert_item (GpkPackageModel *model, PkPackage *item, guint rank,
+			     GpkApplicationPrivate *priv)
+{
+	PkPackage *latest;
+
+	/* the daemon may have replied since this was ranked */
+	latest = g_hash_table_lookup (priv->results_package_ids, pk_package_get_id (item));
+	if (latest != NULL)
+		item = latest;
+
+	/* the text and icon are only worked out when the row is shown */
+	gpk_package_model_add_ranked (model, item,
+				      gpk_application_get_item_state (priv, item), rank);
+}
+
+static gboolean
+gpk_application_results_idle_cb (GpkApplicationPrivate *priv)
+{
+	/* only use part of a frame, so we never stall redraws or input */
+	gpk_results_add (priv->packages_store, priv->results_ranked, GPK_RESULTS_BUDGET,
+			 (GpkResultsAddFunc) gpk_application_insert_item, priv);
+	if (priv->results_ranked->len > 0)
+		return G_SOURCE_CONTINUE;
+
+	/* this runs again when the worker thread returns */
+	priv->results_id = 0;
+	if (priv->results_ranking != NULL)
+		return G_SOURCE_REMOVE;
+
+	/* all done */
+	if (priv->results_finished)
+		gpk_application_results_finished (priv);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+gpk_application_results_queue (GpkApplicationPrivate *priv)
+{
+	if (priv->results_id > 0)
+		return;
+	priv->results_id = g_idle_add ((GSourceFunc) gpk_application_results_idle_cb, priv);
+	g_source_set_name_by_id (priv->results_id, "[GpkApplication] add-results");
+}
+
+static void
+gpk_application_ranked_item_clear (GpkResultsItem *item)
+{
+	g_object_unref (item->package);
+}
+
+static void
+gpk_application_rank_job_free (GpkApplicationRankJob *job)
+{
+	g_ptr_array_unref (job->packages);
+	g_strfreev (job->terms);
+	if (job->ranked != NULL)
+		g_array_unref (job->ranked);
+	g_free (job);
+}
+
+static void
+gpk_application_rank_thread_cb (GTask *task,
+				gpointer source_object,
+				gpointer task_data,
+				GCancellable *cancellable)
+{
+	GpkApplicationRankJob *job = task_data;
+	GTimer *timer;
+
+	timer = g_timer_new ();
+	job->ranked = gpk_results_rank (job->packages, job->terms);
+	job->elapsed = g_timer_elapsed (timer, NULL) * 1000;
+	g_timer_destroy (timer);
+	g_task_return_boolean (task, TRUE);
+}
+
+static void gpk_application_results_rank (GpkApplicationPrivate *priv);
+
+static void
+gpk_application_results_rank_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	GpkApplicationPrivate *priv = user_data;
+	GpkApplicationRankJob *job = g_task_get_task_data (G_TASK (res));
+	GpkResultsItem item;
+	guint i;
+
+	/* the list has been cleared since */
+	if (job != priv->results_ranking) {
+		g_debug ("ignoring ranking of old results");
+		return;
+	}
+	priv->results_ranking = NULL;
+	g_debug ("ranked %u results in %.2fms", job->ranked->len, job->elapsed);
+
+	for (i = 0; i < job->ranked->len; i++) {
+		item = g_array_index (job->ranked, GpkResultsItem, i);
+		g_object_ref (item.package);
+		g_array_append_val (priv->results_ranked, item);
+	}
+	gpk_application_results_queue (priv);
+
+	/* anything that arrived while the thread was busy */
+	gpk_application_results_rank (priv);
+}
+
+/* scores the pending results in a thread, so they are added best first */
+static void
+gpk_application_results_rank (GpkApplicationPrivate *priv)
+{
+	GpkApplicationRankJob *job;
+	GpkResultsItem item;
+	g_autoptr(GTask) task = NULL;
+	guint i;
+
+	if (priv->results_ranking != NULL || priv->results_pending->len == 0)
+		return;
+
+	/* there is nothing to score a group or the whole list against */
+	if (priv->search_mode != GPK_MODE_NAME_DETAILS_FILE ||
+	    priv->search_terms == NULL) {
+		for (i = 0; i < priv->results_pending->len; i++) {
+			item.package = g_object_ref (g_ptr_array_index (priv->results_pending, i));
+			item.rank = 0;
+			g_array_append_val (priv->results_ranked, item);
+		}
+		g_ptr_array_set_size (priv->results_pending, 0);
+		gpk_application_results_queue (priv);
+		return;
+	}
+
+	job = g_new0 (GpkApplicationRankJob, 1);
+	job->packages = priv->results_pending;
+	job->terms = g_strdupv (priv->search_terms);
+	priv->results_pending = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	priv->results_ranking = job;
+
+	task = g_task_new (NULL, NULL, gpk_application_results_rank_cb, priv);
+	g_task_set_task_data (task, job, (GDestroyNotify) gpk_application_rank_job_free);
+	g_task_run_in_thread (task, gpk_application_rank_thread_cb);
+}
+
+static void
+gpk_application_add_item_to_results (GpkApplicationPrivate *priv, PkPackage *item)
+{
+	const gchar *package_id;
+
+	/* already added from the catalog or when the transaction was
+	 * running, so just keep the newest data */
+	package_id = pk_package_get_id (item);
+	if (g_hash_table_contains (priv->results_package_ids, package_id)) {
+		g_hash_table_insert (priv->results_package_ids, g_strdup (package_id),
+				     g_object_ref (item));
+		gpk_package_model_update (priv->packages_store, item,
+					  gpk_application_get_item_state (priv, item));
+		return;
+	}
+	g_hash_table_insert (priv->results_package_ids, g_strdup (package_id), g_object_ref (item));
 
-	/* only process every n events else we re-order too many times */
-	if (package_cnt++ % 200 == 0) {
-		while (gtk_events_pending ())
-			gtk_main_iteration ();
+	/* mark as got so we don't warn */
+	priv->has_package = TRUE;
+
+	/* add to the store when ranked */
+	g_ptr_array_add (priv->results_pending, g_object_ref (item));
+	gpk_application_results_rank (priv);
+}
+
+/* run the finished actions once every pending row is in the store */
+static void
+gpk_application_results_set_finished (GpkApplicationPrivate *priv)
+{
+	priv->results_finished = TRUE;
+	gpk_application_results_queue (priv);
+}
+
+/* the search with each misspelt word replaced, or NULL if none were */
+static gchar *
+gpk_application_get_suggestion (GpkApplicationPrivate *priv)
+{
+	gboolean changed = FALSE;
+	gchar *word;
+	gint64 start;
+	guint i;
+	g_autoptr(GPtrArray) words = NULL;
+
+	if (priv->catalog_index == NULL ||
+	    priv->search_terms == NULL ||
+	    priv->search_type == GPK_SEARCH_FILE)
+		return NULL;
+
+	start = g_get_monotonic_time ();
+	words = g_ptr_array_new_with_free_func (g_free);
+	for (i = 0; priv->search_terms[i] != NULL; i++) {
+		word = gpk_trigram_index_suggest (priv->catalog_index, priv->search_terms[i]);
+		if (word != NULL)
+			changed = TRUE;
+		else
+			word = g_strdup (priv->search_terms[i]);
+		g_ptr_array_add (words, word);
 	}
+	g_ptr_array_add (words, NULL);
+	g_debug ("looked for suggestions in %" G_GINT64_FORMAT "us",
+		 g_get_monotonic_time () - start);
+	if (!changed)
+		return NULL;
+	return g_strjoinv (" ", (gchar **) words->pdata);
 }
 
 static void
@@ -1080,9 +1958,9 @@ gpk_application_suggest_better_search (GpkApplicationPrivate *priv)
 	const gchar *message = NULL;
 	/* TRANSLATORS: no results were found for this search */
 	const gchar *title = _("No results were found.");
-	GtkTreeIter iter;
 	g_autofree gchar *text = NULL;
-	PkBitfield state = 0;
+	g_autofree gchar *suggestion = NULL;
+	g_autofree gchar *suggestion_text = NULL;
 
 	if (priv->search_mode == GPK_MODE_GROUP ||
 	    priv->search_mode == GPK_MODE_ALL_PACKAGES) {
@@ -1091,26 +1969,22 @@ gpk_application_suggest_better_search (GpkApplicationPrivate *priv)
 	}  else if (priv->search_mode == GPK_MODE_SELECTED) {
 		/* TRANSLATORS: nothing in the package queue */
 		message = _("There are no packages queued to be installed or removed.");
+	} else if ((suggestion = gpk_application_get_suggestion (priv)) != NULL) {
+		/* TRANSLATORS: the search text looks misspelt, %s is the search that was probably meant */
+		suggestion_text = g_strdup_printf (_("Did you mean “%s”?"), suggestion);
+		message = suggestion_text;
 	} else {
-		if (priv->search_type == GPK_SEARCH_NAME ||
-		    priv->search_type == GPK_SEARCH_FILE)
-			/* TRANSLATORS: tell the user to switch to details search mode */
-			message = _("Try searching package descriptions by clicking the icon next to the search text.");
+		if (priv->search_type != GPK_SEARCH_ALL &&
+		    pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_SEARCH_NAME))
+			/* TRANSLATORS: tell the user to switch to the all fields search mode */
+			message = _("Try searching all fields by clicking the icon next to the search text.");
 		else
 			/* TRANSLATORS: tell the user to try harder */
 			message = _("Try again with a different search term.");
 	}
 
 	text = g_strdup_printf ("%s\n%s", title, message);
-	gtk_list_store_append (priv->packages_store, &iter);
-	gtk_list_store_set (priv->packages_store, &iter,
-			    PACKAGES_COLUMN_STATE, state,
-			    PACKAGES_COLUMN_CHECKBOX, FALSE,
-			    PACKAGES_COLUMN_CHECKBOX_VISIBLE, FALSE,
-			    PACKAGES_COLUMN_TEXT, text,
-			    PACKAGES_COLUMN_IMAGE, "system-search",
-			    PACKAGES_COLUMN_ID, NULL,
-			    -1);
+	gpk_package_model_add_message (priv->packages_store, "system-search", text);
 }
 
 static gboolean
@@ -1130,76 +2004,292 @@ static void
 gpk_application_select_exact_match (GpkApplicationPrivate *priv, const gchar *text)
 {
 	GtkTreeView *treeview;
-	gboolean valid;
 	GtkTreeIter iter;
 	GtkTreePath *path;
-	GtkTreeModel *model;
-	GtkTreeSelection *selection = NULL;
+	GtkTreeSelection *selection;
 
-	/* get the first iter in the array */
+	/* exact match, so select and scroll */
+	if (!gpk_package_model_find_name (priv->packages_store, text, &iter))
+		return;
 	treeview = GTK_TREE_VIEW (gtk_builder_get_object (priv->builder, "treeview_packages"));
-	model = gtk_tree_view_get_model (treeview);
-	valid = gtk_tree_model_get_iter_first (model, &iter);
+	selection = gtk_tree_view_get_selection (treeview);
+	gtk_tree_selection_select_iter (selection, &iter);
+	path = gtk_tree_model_get_path (GTK_TREE_MODEL (priv->packages_store), &iter);
+	gtk_tree_view_scroll_to_cell (treeview, path, NULL, FALSE, 0.5f, 0.5f);
+	gtk_tree_path_free (path);
+}
 
-	/* for all items in treeview */
-	while (valid) {
-		g_autofree gchar *package_id = NULL;
-		gtk_tree_model_get (model, &iter, PACKAGES_COLUMN_ID, &package_id, -1);
-		if (package_id != NULL) {
-			g_auto(GStrv) split = NULL;
-			/* exact match, so select and scroll */
-			split = pk_package_id_split (package_id);
-			if (g_strcmp0 (split[PK_PACKAGE_ID_NAME], text) == 0) {
-				selection = gtk_tree_view_get_selection (treeview);
-				gtk_tree_selection_select_iter (selection, &iter);
-				path = gtk_tree_model_get_path (model, &iter);
-				gtk_tree_view_scroll_to_cell (treeview, path, NULL, FALSE, 0.5f, 0.5f);
-				gtk_tree_path_free (path);
-			}
+static void
+gpk_application_results_finished (GpkApplicationPrivate *priv)
+{
+	priv->results_finished = FALSE;
 
-			/* no point continuing for a second match */
-			if (selection != NULL)
-				break;
+	/* were there no entries found? */
+	if (!priv->has_package)
+		gpk_application_suggest_better_search (priv);
+
+	/* if there is an exact match, select it */
+	gpk_application_select_exact_match (priv, priv->search_text);
+
+	/* this list can be gone back to */
+	gpk_application_history_set_current (priv);
+
+	/* get the details of what is on screen before it is clicked */
+	gpk_application_details_prefetch (priv);
+
+	/* and warm the popular groups once the user is idle */
+	gpk_application_groups_prefetch_schedule (priv);
+}
+
+/* lower case, without the empty strings from repeated spaces */
+static gchar **
+gpk_application_get_search_terms (const gchar *text)
+{
+	guint i;
+	GPtrArray *array;
+	g_auto(GStrv) split = NULL;
+
+	array = g_ptr_array_new ();
+	split = g_strsplit (text, " ", -1);
+	for (i = 0; split[i] != NULL; i++) {
+		if (split[i][0] == '\0')
+			continue;
+		g_ptr_array_add (array, g_utf8_strdown (split[i], -1));
+	}
+	g_ptr_array_add (array, NULL);
+	return (gchar **) g_ptr_array_free (array, FALSE);
+}
+
+static gboolean
+gpk_application_refine_filter_cb (PkPackage *package, GpkApplicationRefineHelper *helper)
+{
+	const gchar *package_id;
+	gboolean ret = TRUE;
+	guint i;
+	g_autofree gchar *name = NULL;
+
+	package_id = pk_package_get_id (package);
+	if (helper->ids != NULL) {
+		ret = g_hash_table_contains (helper->ids, package_id);
+	} else {
+		name = g_utf8_strdown (pk_package_get_name (package), -1);
+		for (i = 0; ret && helper->terms[i] != NULL; i++)
+			ret = strstr (name, helper->terms[i]) != NULL;
+	}
+
+	/* allow it to be added again */
+	if (!ret)
+		g_hash_table_remove (helper->priv->results_package_ids, package_id);
+	return ret;
+}
+
+static void
+gpk_application_results_filter (GpkApplicationPrivate *priv, GpkApplicationRefineHelper *helper)
+{
+	GpkResultsItem *item;
+	PkPackage *package;
+	guint i;
+	guint removed;
+
+	/* what the thread is ranking is filtered and ranked again */
+	if (priv->results_ranking != NULL) {
+		for (i = 0; i < priv->results_ranking->packages->len; i++) {
+			package = g_ptr_array_index (priv->results_ranking->packages, i);
+			g_ptr_array_add (priv->results_pending, g_object_ref (package));
 		}
-		valid = gtk_tree_model_iter_next (model, &iter);
+		priv->results_ranking = NULL;
 	}
+
+	/* rows that are still waiting to be added */
+	for (i = 0; i < priv->results_pending->len; ) {
+		package = g_ptr_array_index (priv->results_pending, i);
+		if (gpk_application_refine_filter_cb (package, helper))
+			i++;
+		else
+			g_ptr_array_remove_index_fast (priv->results_pending, i);
+	}
+	for (i = 0; i < priv->results_ranked->len; ) {
+		item = &g_array_index (priv->results_ranked, GpkResultsItem, i);
+		if (gpk_application_refine_filter_cb (item->package, helper))
+			i++;
+		else
+			g_array_remove_index (priv->results_ranked, i);
+	}
+	gpk_application_results_rank (priv);
+
+	removed = gpk_package_model_filter (priv->packages_store,
+					    (GpkPackageModelFilterFunc) gpk_application_refine_filter_cb,
+					    helper);
+	priv->has_package = g_hash_table_size (priv->results_package_ids) > 0;
+	g_debug ("removed %u rows, %u left", removed,
+		 g_hash_table_size (priv->results_package_ids));
+}
+
+/* every old term is still there, even if the user has made it longer */
+static gboolean
+gpk_application_search_is_refinement (gchar **old_terms, gchar **new_terms)
+{
+	gboolean found;
+	guint i;
+	guint j;
+
+	for (i = 0; old_terms[i] != NULL; i++) {
+		found = FALSE;
+		for (j = 0; !found && new_terms[j] != NULL; j++)
+			found = strstr (new_terms[j], old_terms[i]) != NULL;
+		if (!found)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/* narrow the rows we already have, while the daemon checks the answer */
+static gboolean
+gpk_application_search_refine (GpkApplicationPrivate *priv)
+{
+	GpkApplicationRefineHelper helper = { priv, NULL, NULL };
+	GtkEntry *entry;
+	const gchar *text;
+	g_autofree gchar *new_joined = NULL;
+	g_autofree gchar *old_joined = NULL;
+	g_auto(GStrv) new_terms = NULL;
+	g_auto(GStrv) old_terms = NULL;
+
+	/* we only have the name to check against */
+	if (priv->search_mode != GPK_MODE_NAME_DETAILS_FILE ||
+	    priv->search_type != GPK_SEARCH_NAME)
+		return FALSE;
+	if (priv->refine_text == NULL ||
+	    priv->refine_filters != gpk_application_get_backend_filters (priv))
+		return FALSE;
+
+	entry = GTK_ENTRY (gtk_builder_get_object (priv->builder, "entry_text"));
+	text = gtk_entry_get_text (entry);
+	new_terms = gpk_application_get_search_terms (text);
+	old_terms = gpk_application_get_search_terms (priv->refine_text);
+	if (g_strv_length (new_terms) == 0)
+		return FALSE;
+	new_joined = g_strjoinv (" ", new_terms);
+	old_joined = g_strjoinv (" ", old_terms);
+	if (g_strcmp0 (new_joined, old_joined) == 0)
+		return FALSE;
+	if (!gpk_application_search_is_refinement (old_terms, new_terms))
+		return FALSE;
+
+	g_debug ("refining '%s' to '%s'", priv->refine_text, text);
+	helper.terms = new_terms;
+	gpk_application_results_filter (priv, &helper);
+	priv->search_refined = TRUE;
+	return TRUE;
 }
 
+/* the daemon has the final say on what a refined search matches */
 static void
-gpk_application_cancel_cb (GtkWidget *button_widget, GpkApplicationPrivate *priv)
+gpk_application_results_reconcile (GpkApplicationPrivate *priv, GPtrArray *array)
 {
-	g_cancellable_cancel (priv->cancellable);
+	GpkApplicationRefineHelper helper = { priv, NULL, NULL };
+	guint i;
 
-	/* switch buttons around */
-	priv->search_mode = GPK_MODE_UNKNOWN;
+	/* rows the daemon gave a new summary are moved into place */
+	gpk_package_model_sort_added (priv->packages_store);
+
+	if (!priv->search_refined)
+		return;
+	priv->search_refined = FALSE;
+
+	helper.ids = g_hash_table_new (g_str_hash, g_str_equal);
+	for (i = 0; i < array->len; i++)
+		g_hash_table_add (helper.ids, (gpointer) pk_package_get_id (g_ptr_array_index (array, i)));
+	gpk_application_results_filter (priv, &helper);
+	g_hash_table_unref (helper.ids);
+}
+
+static gint
+gpk_application_strcmp_cb (gconstpointer a, gconstpointer b)
+{
+	return g_strcmp0 (*((const gchar **) a), *((const gchar **) b));
 }
 
 static void
-gpk_application_set_button_find_sensitivity (GpkApplicationPrivate *priv)
+gpk_application_search_helper_free (GpkApplicationSearchHelper *helper)
 {
-	GtkWidget *widget;
+	g_object_unref (helper->cancellable);
+	g_free (helper);
+}
 
-	/* only sensitive if not in the middle of a search */
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "entry_text"));
-	gtk_widget_set_sensitive (widget, !priv->search_in_progress);
+/* stops any running search and makes a new cancellable for the next one */
+static void
+gpk_application_search_cancel (GpkApplicationPrivate *priv)
+{
+	priv->search_generation++;
+	if (priv->search_cancellable != NULL) {
+		g_cancellable_cancel (priv->search_cancellable);
+		g_object_unref (priv->search_cancellable);
+	}
+	priv->search_cancellable = g_cancellable_new ();
+	priv->search_in_progress = FALSE;
+	priv->search_pending = 0;
+	priv->search_failed = FALSE;
+	priv->search_succeeded = FALSE;
+	g_ptr_array_set_size (priv->search_results, 0);
+}
+
+/* a search can be made of several transactions, and is done when they all are */
+static GpkApplicationSearchHelper *
+gpk_application_search_helper_new (GpkApplicationPrivate *priv, gboolean show_errors)
+{
+	GpkApplicationSearchHelper *helper = g_new0 (GpkApplicationSearchHelper, 1);
+	helper->priv = priv;
+	helper->cancellable = g_object_ref (priv->search_cancellable);
+	helper->generation = priv->search_generation;
+	helper->show_errors = show_errors;
+	priv->search_pending++;
+	return helper;
 }
 
 static void
-gpk_application_search_cb (PkClient *client, GAsyncResult *res, GpkApplicationPrivate *priv)
+gpk_application_cancel_cb (GtkWidget *button_widget, GpkApplicationPrivate *priv)
 {
+	g_cancellable_cancel (priv->cancellable);
+	gpk_application_search_cancel (priv);
+	gpk_application_requests_cancel (priv, GPK_APPLICATION_REQUEST_LAST);
+
+	/* switch buttons around */
+	priv->search_mode = GPK_MODE_UNKNOWN;
+}
+
+static void
+gpk_application_search_cb (PkClient *client, GAsyncResult *res, GpkApplicationSearchHelper *helper)
+{
+	GpkApplicationPrivate *priv = helper->priv;
 	g_autoptr(PkResults) results = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(PkError) error_code = NULL;
 	g_autoptr(GPtrArray) array = NULL;
+	g_autoptr(GPtrArray) merged = NULL;
+	g_autoptr(GHashTable) merged_ids = NULL;
 	PkPackage *item;
+	gboolean show_errors;
 	guint i;
 	GtkWidget *widget;
 	GtkWindow *window;
 
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
+
+	/* a newer search has replaced this one */
+	if (helper->generation != priv->search_generation) {
+		g_debug ("ignoring results from old search");
+		gpk_application_search_helper_free (helper);
+		return;
+	}
+	show_errors = helper->show_errors;
+	gpk_application_search_helper_free (helper);
+	priv->search_pending--;
+
 	if (results == NULL) {
 		g_warning ("failed to search: %s", error->message);
+		priv->search_failed = TRUE;
 		goto out;
 	}
 
@@ -1207,9 +2297,11 @@ gpk_application_search_cb (PkClient *client, GAsyncResult *res, GpkApplicationPr
 	error_code = pk_results_get_error_code (results);
 	if (error_code != NULL) {
 		g_warning ("failed to search: %s, %s", pk_error_enum_to_string (pk_error_get_code (error_code)), pk_error_get_details (error_code));
+		priv->search_failed = TRUE;
 
 		/* if obvious message, don't tell the user */
-		if (pk_error_get_code (error_code) != PK_ERROR_ENUM_TRANSACTION_CANCELLED) {
+		if (show_errors &&
+		    pk_error_get_code (error_code) != PK_ERROR_ENUM_TRANSACTION_CANCELLED) {
 			window = GTK_WINDOW (gtk_builder_get_object (priv->builder, "window_manager"));
 			gpk_error_dialog_modal (window, gpk_error_enum_to_localised_text (pk_error_get_code (error_code)),
 						gpk_error_enum_to_localised_message (pk_error_get_code (error_code)), pk_error_get_details (error_code));
@@ -1217,23 +2309,53 @@ gpk_application_search_cb (PkClient *client, GAsyncResult *res, GpkApplicationPr
 		goto out;
 	}
 
-	/* get data */
+	/* add anything we did not get as a progress update */
 	array = pk_results_get_package_array (results);
 	for (i = 0; i < array->len; i++) {
 		item = g_ptr_array_index (array, i);
 		gpk_application_add_item_to_results (priv, item);
+		g_ptr_array_add (priv->search_results, g_object_ref (item));
+	}
+	priv->search_succeeded = TRUE;
+out:
+	/* wait for the other transactions in this search */
+	if (priv->search_pending > 0)
+		return;
+	priv->search_in_progress = FALSE;
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "scrolledwindow_groups"));
+	gtk_widget_set_sensitive (widget, TRUE);
+	if (!priv->search_succeeded) {
+		/* what the catalog had is better than nothing */
+		if (priv->results_from_catalog) {
+			priv->search_refined = FALSE;
+			gpk_application_results_set_finished (priv);
+		}
+		return;
 	}
 
-	/* were there no entries found? */
-	if (!priv->has_package)
-		gpk_application_suggest_better_search (priv);
-
-	/* if there is an exact match, select it */
-	gpk_application_select_exact_match (priv, priv->search_text);
+	/* a package can be found by more than one of the transactions */
+	merged = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	merged_ids = g_hash_table_new (g_str_hash, g_str_equal);
+	for (i = 0; i < priv->search_results->len; i++) {
+		item = g_ptr_array_index (priv->search_results, i);
+		if (!g_hash_table_add (merged_ids, (gpointer) pk_package_get_id (item)))
+			continue;
+		g_ptr_array_add (merged, g_object_ref (item));
+	}
+	gpk_application_results_reconcile (priv, merged);
+	gpk_application_results_set_finished (priv);
+
+	/* save for next time, unless some of it is missing */
+	if (priv->search_key != NULL && !priv->search_failed) {
+		gpk_application_cache_insert (priv->search_cache, priv->search_key,
+					      g_ptr_array_ref (merged));
+		if (priv->search_mode != GPK_MODE_NAME_DETAILS_FILE)
+			gpk_application_catalog_save (priv, priv->search_key, merged);
+	}
 
-	/* focus back to the text extry */
+	/* focus back to the text extry, without selecting what the user is typing */
 	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "entry_text"));
-	gtk_widget_grab_focus (widget);
+	gtk_entry_grab_focus_without_selecting (GTK_ENTRY (widget));
 
 	/* reset UI */
 	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "treeview_groups"));
@@ -1244,12 +2366,121 @@ gpk_application_search_cb (PkClient *client, GAsyncResult *res, GpkApplicationPr
 	gtk_widget_set_sensitive (widget, TRUE);
 	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "button_apply"));
 	gtk_widget_set_sensitive (widget, TRUE);
-out:
-	/* mark find button sensitive */
-	priv->search_in_progress = FALSE;
-	gpk_application_set_button_find_sensitivity (priv);
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "scrolledwindow_groups"));
-	gtk_widget_set_sensitive (widget, TRUE);
+}
+
+/* the same query always gives the same key, whatever the case or word order */
+static gchar *
+gpk_application_get_search_key_full (GpkSearchMode mode,
+				     GpkSearchType type,
+				     PkBitfield filters,
+				     const gchar *terms)
+{
+	g_autofree gchar *filters_str = NULL;
+	g_autofree gchar *terms_joined = NULL;
+	g_auto(GStrv) split = NULL;
+
+	/* the type only matters when searching for text */
+	if (mode != GPK_MODE_NAME_DETAILS_FILE)
+		type = GPK_SEARCH_UNKNOWN;
+
+	if (terms != NULL) {
+		split = gpk_application_get_search_terms (terms);
+		qsort (split, g_strv_length (split), sizeof (gchar *), gpk_application_strcmp_cb);
+		terms_joined = g_strjoinv (" ", split);
+	}
+
+	filters_str = pk_filter_bitfield_to_string (filters);
+	return g_strdup_printf ("%i|%i|%s|%s", mode, type, filters_str,
+				terms_joined != NULL ? terms_joined : "");
+}
+
+static gchar *
+gpk_application_get_search_key (GpkApplicationPrivate *priv)
+{
+	const gchar *terms = NULL;
+
+	if (priv->search_mode == GPK_MODE_NAME_DETAILS_FILE)
+		terms = priv->search_text;
+	else if (priv->search_mode == GPK_MODE_GROUP)
+		terms = priv->search_group;
+	return gpk_application_get_search_key_full (priv->search_mode,
+						    priv->search_type,
+						    gpk_application_get_backend_filters (priv),
+						    terms);
+}
+
+/* returns TRUE if the results were already known */
+static gboolean
+gpk_application_search_from_cache (GpkApplicationPrivate *priv)
+{
+	GPtrArray *array;
+	guint i;
+
+	g_free (priv->search_key);
+	priv->search_key = gpk_application_get_search_key (priv);
+	array = gpk_application_cache_lookup (priv->search_cache, priv->search_key);
+	if (array == NULL)
+		return FALSE;
+
+	for (i = 0; i < array->len; i++)
+		gpk_application_add_item_to_results (priv, g_ptr_array_index (array, i));
+	gpk_application_results_reconcile (priv, array);
+	gpk_application_results_set_finished (priv);
+	return TRUE;
+}
+
+/* anything the daemon told us may now be out of date */
+static void
+gpk_application_caches_invalidate (GpkApplicationPrivate *priv)
+{
+	gpk_application_cache_clear (priv->search_cache);
+	gpk_application_cache_clear (priv->details_cache);
+	gpk_application_history_clear (priv);
+	gpk_application_requests_cancel (priv, GPK_APPLICATION_REQUEST_GROUP_PREFETCH);
+
+	/* don't save the results of a search that is still running */
+	g_clear_pointer (&priv->search_key, g_free);
+}
+
+/* file searches only make sense for something that looks like a path */
+static gboolean
+gpk_application_search_is_path (gchar **searches)
+{
+	guint i;
+	for (i = 0; searches[i] != NULL; i++) {
+		if (strchr (searches[i], '/') != NULL)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/* the transactions run at the same time, and the results are shown as they arrive */
+static void
+gpk_application_search_all (GpkApplicationPrivate *priv, gchar **searches)
+{
+	GpkApplicationSearchHelper *helper;
+	PkBitfield filters = gpk_application_get_backend_filters (priv);
+
+	helper = gpk_application_search_helper_new (priv, TRUE);
+	pk_task_search_names_async (priv->task, filters,
+				    searches, helper->cancellable,
+				    (PkProgressCallback) gpk_application_search_progress_cb, helper,
+				    (GAsyncReadyCallback) gpk_application_search_cb, helper);
+	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_SEARCH_DETAILS)) {
+		helper = gpk_application_search_helper_new (priv, FALSE);
+		pk_task_search_details_async (priv->task, filters,
+					      searches, helper->cancellable,
+					      (PkProgressCallback) gpk_application_search_progress_cb, helper,
+					      (GAsyncReadyCallback) gpk_application_search_cb, helper);
+	}
+	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_SEARCH_FILE) &&
+	    gpk_application_search_is_path (searches)) {
+		helper = gpk_application_search_helper_new (priv, FALSE);
+		pk_task_search_files_async (priv->task, filters,
+					    searches, helper->cancellable,
+					    (PkProgressCallback) gpk_application_search_progress_cb, helper,
+					    (GAsyncReadyCallback) gpk_application_search_cb, helper);
+	}
 }
 
 static void
@@ -1259,6 +2490,7 @@ gpk_application_perform_search_name_details_file (GpkApplicationPrivate *priv)
 	GtkWindow *window;
 	g_autoptr(GError) error = NULL;
 	gboolean ret;
+	GpkApplicationSearchHelper *helper;
 	g_auto(GStrv) searches = NULL;
 
 	entry = GTK_ENTRY (gtk_builder_get_object (priv->builder, "entry_text"));
@@ -1284,34 +2516,45 @@ gpk_application_perform_search_name_details_file (GpkApplicationPrivate *priv)
 		return;
 	}
 	g_debug ("find %s", priv->search_text);
+	g_strfreev (priv->search_terms);
+	priv->search_terms = gpk_application_get_search_terms (priv->search_text);
 
-	/* mark find button insensitive */
-	priv->search_in_progress = TRUE;
-	gpk_application_set_button_find_sensitivity (priv);
+	/* what is in the list now, so the next search can refine it */
+	g_free (priv->refine_text);
+	priv->refine_text = g_strdup (priv->search_text);
+	priv->refine_filters = gpk_application_get_backend_filters (priv);
 
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
+	/* we already know the answer */
+	if (gpk_application_search_from_cache (priv))
+		return;
+
+	priv->search_in_progress = TRUE;
 
 	/* do the search */
 	searches = g_strsplit (priv->search_text, " ", -1);
-	if (priv->search_type == GPK_SEARCH_NAME) {
+	if (priv->search_type == GPK_SEARCH_ALL) {
+		gpk_application_search_all (priv, searches);
+	} else if (priv->search_type == GPK_SEARCH_NAME) {
+		helper = gpk_application_search_helper_new (priv, TRUE);
 		pk_task_search_names_async (priv->task,
-					     priv->filters_current,
-					     searches, priv->cancellable,
-					     (PkProgressCallback) gpk_application_progress_cb, priv,
-					     (GAsyncReadyCallback) gpk_application_search_cb, priv);
+					     gpk_application_get_backend_filters (priv),
+					     searches, helper->cancellable,
+					     (PkProgressCallback) gpk_application_search_progress_cb, helper,
+					     (GAsyncReadyCallback) gpk_application_search_cb, helper);
 	} else if (priv->search_type == GPK_SEARCH_DETAILS) {
+		helper = gpk_application_search_helper_new (priv, TRUE);
 		pk_task_search_details_async (priv->task,
-					     priv->filters_current,
-					     searches, priv->cancellable,
-					     (PkProgressCallback) gpk_application_progress_cb, priv,
-					     (GAsyncReadyCallback) gpk_application_search_cb, priv);
+					     gpk_application_get_backend_filters (priv),
+					     searches, helper->cancellable,
+					     (PkProgressCallback) gpk_application_search_progress_cb, helper,
+					     (GAsyncReadyCallback) gpk_application_search_cb, helper);
 	} else if (priv->search_type == GPK_SEARCH_FILE) {
+		helper = gpk_application_search_helper_new (priv, TRUE);
 		pk_task_search_files_async (priv->task,
-					     priv->filters_current,
-					     searches, priv->cancellable,
-					     (PkProgressCallback) gpk_application_progress_cb, priv,
-					     (GAsyncReadyCallback) gpk_application_search_cb, priv);
+					     gpk_application_get_backend_filters (priv),
+					     searches, helper->cancellable,
+					     (PkProgressCallback) gpk_application_search_progress_cb, helper,
+					     (GAsyncReadyCallback) gpk_application_search_cb, helper);
 	} else {
 		g_warning ("invalid search type");
 		return;
@@ -1328,26 +2571,52 @@ gpk_application_perform_search_name_details_file (GpkApplicationPrivate *priv)
 	}
 }
 
+/* shows the list saved last time at once, the daemon's answer then replaces it */
+static void
+gpk_application_search_from_catalog (GpkApplicationPrivate *priv)
+{
+	guint i;
+	g_autoptr(GPtrArray) array = NULL;
+
+	if (priv->search_key == NULL)
+		return;
+	array = gpk_catalog_lookup (priv->catalog, priv->search_key);
+	if (array == NULL)
+		return;
+	g_debug ("showing %u packages from the catalog", array->len);
+	for (i = 0; i < array->len; i++)
+		gpk_application_add_item_to_results (priv, g_ptr_array_index (array, i));
+
+	/* anything the daemon no longer has is removed when it replies */
+	priv->search_refined = TRUE;
+	priv->results_from_catalog = TRUE;
+}
+
 static void
 gpk_application_perform_search_others (GpkApplicationPrivate *priv)
 {
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
+	GpkApplicationSearchHelper *helper;
+
+	/* we already know the answer */
+	if (gpk_application_search_from_cache (priv))
+		return;
+	gpk_application_search_from_catalog (priv);
 
 	priv->search_in_progress = TRUE;
 
+	helper = gpk_application_search_helper_new (priv, TRUE);
 	if (priv->search_mode == GPK_MODE_GROUP) {
 		g_auto(GStrv) search_groups = NULL;
 		search_groups = g_strsplit (priv->search_group, " ", -1);
 		pk_client_search_groups_async (PK_CLIENT(priv->task),
-					       priv->filters_current, search_groups, priv->cancellable,
-					       (PkProgressCallback) gpk_application_progress_cb, priv,
-					       (GAsyncReadyCallback) gpk_application_search_cb, priv);
+					       gpk_application_get_backend_filters (priv), search_groups, helper->cancellable,
+					       (PkProgressCallback) gpk_application_search_progress_cb, helper,
+					       (GAsyncReadyCallback) gpk_application_search_cb, helper);
 	} else {
 		pk_client_get_packages_async (PK_CLIENT(priv->task),
-					      priv->filters_current, priv->cancellable,
-					      (PkProgressCallback) gpk_application_progress_cb, priv,
-					      (GAsyncReadyCallback) gpk_application_search_cb, priv);
+					      gpk_application_get_backend_filters (priv), helper->cancellable,
+					      (PkProgressCallback) gpk_application_search_progress_cb, helper,
+					      (GAsyncReadyCallback) gpk_application_search_cb, helper);
 	}
 }
 
@@ -1378,17 +2647,30 @@ gpk_application_populate_selected (GpkApplicationPrivate *priv)
 static void
 gpk_application_perform_search (GpkApplicationPrivate *priv)
 {
-	/*if we are in the middle of a search, just return*/
-	if (priv->search_in_progress == TRUE)
-		return;
-
 	/* just shown the welcome screen */
 	if (priv->search_mode == GPK_MODE_UNKNOWN)
 		return;
 
+	/* the newest query always wins */
+	if (priv->search_delay_id > 0) {
+		g_source_remove (priv->search_delay_id);
+		priv->search_delay_id = 0;
+	}
+	gpk_application_search_cancel (priv);
+
+	/* the user is waiting for this, the prefetch can be redone afterwards */
+	gpk_application_requests_cancel (priv, GPK_APPLICATION_REQUEST_PREFETCH);
+	gpk_application_requests_cancel (priv, GPK_APPLICATION_REQUEST_GROUP_PREFETCH);
+	gpk_application_requests_cancel (priv, GPK_APPLICATION_REQUEST_CATALOG);
+	if (priv->group_prefetch_id > 0) {
+		g_source_remove (priv->group_prefetch_id);
+		priv->group_prefetch_id = 0;
+	}
+
 	g_debug ("CLEAR search");
 	gpk_application_clear_details (priv);
-	gpk_application_clear_packages (priv);
+	if (!gpk_application_search_refine (priv))
+		gpk_application_clear_packages (priv);
 
 	if (priv->search_mode == GPK_MODE_NAME_DETAILS_FILE) {
 		gpk_application_perform_search_name_details_file (priv);
@@ -1445,15 +2727,27 @@ gpk_application_quit (GpkApplicationPrivate *priv)
 
 	/* we might have visual stuff running, close them down */
 	g_cancellable_cancel (priv->cancellable);
+	g_cancellable_cancel (priv->search_cancellable);
+	gpk_application_requests_cancel (priv, GPK_APPLICATION_REQUEST_LAST);
 	g_application_release (G_APPLICATION (priv->application));
 	return TRUE;
 }
 
+static gboolean
+gpk_application_search_delay_cb (GpkApplicationPrivate *priv)
+{
+	priv->search_delay_id = 0;
+	priv->search_mode = GPK_MODE_NAME_DETAILS_FILE;
+	gpk_application_perform_search (priv);
+	return G_SOURCE_REMOVE;
+}
+
 static gboolean
 gpk_application_text_changed_cb (GtkEntry *entry, GpkApplicationPrivate *priv)
 {
 	GtkTreeView *treeview;
 	GtkTreeSelection *selection;
+	guint delay;
 
 	/* clear group selection if we have the tab */
 	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_SEARCH_GROUP) &&
@@ -1463,8 +2757,17 @@ gpk_application_text_changed_cb (GtkEntry *entry, GpkApplicationPrivate *priv)
 		gtk_tree_selection_unselect_all (selection);
 	}
 
-	/* mark find button sensitive */
-	gpk_application_set_button_find_sensitivity (priv);
+	/* search as the user types, once they pause */
+	if (priv->search_delay_id > 0) {
+		g_source_remove (priv->search_delay_id);
+		priv->search_delay_id = 0;
+	}
+	delay = g_settings_get_uint (priv->settings, GPK_SETTINGS_SEARCH_DELAY);
+	if (delay > 0 && gtk_entry_get_text_length (entry) > 0) {
+		priv->search_delay_id =
+			g_timeout_add (delay, (GSourceFunc) gpk_application_search_delay_cb, priv);
+		g_source_set_name_by_id (priv->search_delay_id, "[GpkApplication] search-delay");
+	}
 	return FALSE;
 }
 
@@ -1485,7 +2788,7 @@ gpk_application_packages_installed_clicked_cb (GtkCellRendererToggle *cell, gcha
 	/* get toggled iter */
 	gtk_tree_model_get_iter (model, &iter, path);
 	gtk_tree_model_get (model, &iter,
-			    PACKAGES_COLUMN_STATE, &state,
+			    GPK_PACKAGE_MODEL_COLUMN_STATE, &state,
 			    -1);
 
 	/* enforce the selection in case we just fire at the checkbox without selecting */
@@ -1506,44 +2809,27 @@ static void
 gpk_application_button_clear_cb (GtkWidget *widget_button, GpkApplicationPrivate *priv)
 {
 	GtkTreeView *treeview;
-	gboolean valid;
-	gboolean checkbox;
 	GtkTreeIter iter;
-	GtkTreeModel *model;
 	GtkTreeSelection *selection;
-	const gchar *icon;
+	GHashTableIter hash_iter;
+	const gchar *package_id;
 	PkBitfield state;
-	gboolean ret;
-
-	/* get the first iter in the array */
-	treeview = GTK_TREE_VIEW (gtk_builder_get_object (priv->builder, "treeview_packages"));
-	model = gtk_tree_view_get_model (treeview);
-	valid = gtk_tree_model_get_iter_first (model, &iter);
 
-	/* for all current items, reset the state if in the array */
-	while (valid) {
-		gtk_tree_model_get (model, &iter, PACKAGES_COLUMN_STATE, &state, -1);
-		ret = pk_bitfield_contain (state, GPK_STATE_IN_LIST);
-		if (ret) {
-			pk_bitfield_remove (state, GPK_STATE_IN_LIST);
-			/* get the new icon */
-			icon = gpk_application_state_get_icon (state);
-			checkbox = gpk_application_state_get_checkbox (state);
-
-			/* set new value */
-			gtk_list_store_set (GTK_LIST_STORE (model), &iter,
-					    PACKAGES_COLUMN_STATE, state,
-					    PACKAGES_COLUMN_CHECKBOX, checkbox,
-					    PACKAGES_COLUMN_IMAGE, icon,
-					    -1);
-		}
-		valid = gtk_tree_model_iter_next (model, &iter);
+	/* only the queued packages can be shown as being in the array */
+	g_hash_table_iter_init (&hash_iter, priv->package_sack_ids);
+	while (g_hash_table_iter_next (&hash_iter, (gpointer *) &package_id, NULL)) {
+		if (!gpk_package_model_find_id (priv->packages_store, package_id, &iter))
+			continue;
+		state = gpk_package_model_get_state (priv->packages_store, &iter);
+		pk_bitfield_remove (state, GPK_STATE_IN_LIST);
+		gpk_package_model_set_state (priv->packages_store, &iter, state);
 	}
 
 	/* clear queue */
-	pk_package_sack_clear (priv->package_sack);
+	gpk_application_queue_clear (priv);
 
 	/* force a button refresh */
+	treeview = GTK_TREE_VIEW (gtk_builder_get_object (priv->builder, "treeview_packages"));
 	selection = gtk_tree_view_get_selection (treeview);
 	gpk_application_packages_treeview_clicked_cb (selection, priv);
 
@@ -1581,12 +2867,15 @@ gpk_application_install_packages_cb (PkTask *task, GAsyncResult *res, GpkApplica
 		return;
 	}
 
+	/* the installed state of the results has changed */
+	gpk_application_caches_invalidate (priv);
+
 	/* idle add in the background */
 	idle_id = g_idle_add ((GSourceFunc) gpk_application_perform_search_idle_cb, priv);
 	g_source_set_name_by_id (idle_id, "[GpkApplication] search");
 
 	/* clear if success */
-	pk_package_sack_clear (priv->package_sack);
+	gpk_application_queue_clear (priv);
 	priv->action = GPK_ACTION_NONE;
 	gpk_application_change_queue_status (priv);
 }
@@ -1621,12 +2910,15 @@ gpk_application_remove_packages_cb (PkTask *task, GAsyncResult *res, GpkApplicat
 		return;
 	}
 
+	/* the installed state of the results has changed */
+	gpk_application_caches_invalidate (priv);
+
 	/* idle add in the background */
 	idle_id = g_idle_add ((GSourceFunc) gpk_application_perform_search_idle_cb, priv);
 	g_source_set_name_by_id (idle_id, "[GpkApplication] search");
 
 	/* clear if success */
-	pk_package_sack_clear (priv->package_sack);
+	gpk_application_queue_clear (priv);
 	priv->action = GPK_ACTION_NONE;
 	gpk_application_change_queue_status (priv);
 }
@@ -1692,8 +2984,8 @@ gpk_application_packages_add_columns (GpkApplicationPrivate *priv)
 
 	/* TRANSLATORS: column for installed status */
 	column = gtk_tree_view_column_new_with_attributes (_("Installed"), renderer,
-							   "active", PACKAGES_COLUMN_CHECKBOX,
-							   "visible", PACKAGES_COLUMN_CHECKBOX_VISIBLE, NULL);
+							   "active", GPK_PACKAGE_MODEL_COLUMN_CHECKBOX,
+							   "visible", GPK_PACKAGE_MODEL_COLUMN_CHECKBOX_VISIBLE, NULL);
 	gtk_tree_view_append_column (treeview, column);
 
 	/* column for images */
@@ -1701,15 +2993,15 @@ gpk_application_packages_add_columns (GpkApplicationPrivate *priv)
 	renderer = gtk_cell_renderer_pixbuf_new ();
 	g_object_set (renderer, "stock-size", GTK_ICON_SIZE_DIALOG, NULL);
 	gtk_tree_view_column_pack_start (column, renderer, FALSE);
-	gtk_tree_view_column_add_attribute (column, renderer, "icon-name", PACKAGES_COLUMN_IMAGE);
+	gtk_tree_view_column_add_attribute (column, renderer, "icon-name", GPK_PACKAGE_MODEL_COLUMN_IMAGE);
 	gtk_tree_view_append_column (treeview, column);
 
 	/* column for name */
 	renderer = gtk_cell_renderer_text_new ();
 	/* TRANSLATORS: column for package name */
 	column = gtk_tree_view_column_new_with_attributes (_("Name"), renderer,
-							   "markup", PACKAGES_COLUMN_TEXT, NULL);
-	gtk_tree_view_column_set_sort_column_id (column, PACKAGES_COLUMN_TEXT);
+							   "markup", GPK_PACKAGE_MODEL_COLUMN_TEXT, NULL);
+	gtk_tree_view_column_set_sort_column_id (column, GPK_PACKAGE_MODEL_COLUMN_TEXT);
 	gtk_tree_view_append_column (treeview, column);
 }
 
@@ -1745,6 +3037,7 @@ gpk_application_groups_treeview_changed_cb (GtkTreeSelection *selection, GpkAppl
 	GtkEntry *entry;
 	GtkTreePath *path;
 	gboolean active;
+	guint count;
 
 	/* hide details */
 	g_debug ("CLEAR tv changed");
@@ -1773,145 +3066,712 @@ gpk_application_groups_treeview_changed_cb (GtkTreeSelection *selection, GpkAppl
 			return;
 		}
 
-		/* GetPackages? */
-		if (g_strcmp0 (priv->search_group, "all-packages") == 0)
-			priv->search_mode = GPK_MODE_ALL_PACKAGES;
-		else if (g_strcmp0 (priv->search_group, "selected") == 0)
-			priv->search_mode = GPK_MODE_SELECTED;
-		else
-			priv->search_mode = GPK_MODE_GROUP;
+		/* GetPackages? */
+		if (g_strcmp0 (priv->search_group, "all-packages") == 0)
+			priv->search_mode = GPK_MODE_ALL_PACKAGES;
+		else if (g_strcmp0 (priv->search_group, "selected") == 0)
+			priv->search_mode = GPK_MODE_SELECTED;
+		else
+			priv->search_mode = GPK_MODE_GROUP;
+
+		/* remember what is popular, so it can be prefetched */
+		if (priv->search_mode != GPK_MODE_SELECTED) {
+			count = GPOINTER_TO_UINT (g_hash_table_lookup (priv->group_usage, priv->search_group));
+			g_hash_table_insert (priv->group_usage, g_strdup (priv->search_group),
+					     GUINT_TO_POINTER (count + 1));
+			gpk_application_startup_cache_save_schedule (priv);
+		}
+
+		/* actually do the search */
+		gpk_application_perform_search (priv);
+	}
+}
+
+static void
+gpk_application_show_details (GpkApplicationPrivate *priv, PkDetails *item)
+{
+	GtkWidget *widget;
+	gchar *value;
+	const gchar *repo_name;
+	gboolean installed;
+	g_auto(GStrv) split = NULL;
+	g_autofree gchar *package_id = NULL;
+	g_autofree gchar *url = NULL;
+	PkGroupEnum group;
+	g_autofree gchar *license = NULL;
+	g_autofree gchar *description = NULL;
+	guint64 size;
+
+	/* show to start */
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "grid_details"));
+	gtk_widget_show (widget);
+
+	/* get data */
+	g_object_get (item,
+		      "package-id", &package_id,
+		      "url", &url,
+		      "group", &group,
+		      "license", &license,
+		      "description", &description,
+		      "size", &size,
+		      NULL);
+
+	split = pk_package_id_split (package_id);
+	installed = g_str_has_prefix (split[PK_PACKAGE_ID_DATA], "installed");
+
+	/* homepage */
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "button_homepage"));
+	g_free (priv->homepage_url);
+	priv->homepage_url = g_strdup (url);
+	gtk_widget_set_visible (widget, url != NULL);
+
+	/* licence */
+	if (license != NULL) {
+		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_licence_title"));
+		gtk_widget_show (widget);
+		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_licence"));
+		gtk_label_set_label (GTK_LABEL (widget), license);
+		gtk_label_set_line_wrap (GTK_LABEL (widget), TRUE);
+		gtk_widget_show (widget);
+	} else {
+		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_licence_title"));
+		gtk_widget_hide (widget);
+		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_licence"));
+		gtk_widget_hide (widget);
+	}
+
+	/* set the description */
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "textview_description"));
+	gpk_application_set_text_buffer (widget, description);
+
+	/* if non-zero, set the size */
+	if (size > 0) {
+		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_size_title"));
+		/* set the size */
+		if (g_strcmp0 (split[PK_PACKAGE_ID_DATA], "meta") == 0) {
+			/* TRANSLATORS: the size of the meta package */
+			gtk_label_set_label (GTK_LABEL (widget), _("Size"));
+		} else if (installed) {
+			/* TRANSLATORS: the installed size in bytes of the package */
+			gtk_label_set_label (GTK_LABEL (widget), _("Installed size"));
+		} else {
+			/* TRANSLATORS: the download size of the package */
+			gtk_label_set_label (GTK_LABEL (widget), _("Download size"));
+		}
+		gtk_widget_show (widget);
+		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_size"));
+		value = g_format_size (size);
+		gtk_label_set_label (GTK_LABEL (widget), value);
+		gtk_widget_show (widget);
+		g_free (value);
+	} else {
+		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_size_title"));
+		gtk_widget_hide (widget);
+		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_size"));
+		gtk_widget_hide (widget);
+	}
+
+	/* set the repo text */
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_source"));
+	/* get the full name of the repo from the repo_id */
+	repo_name = gpk_application_get_full_repo_name (priv, split[PK_PACKAGE_ID_DATA]);
+	gtk_label_set_label (GTK_LABEL (widget), repo_name);
+}
+
+static void
+gpk_application_get_details_process (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request)
+{
+	GpkApplicationPrivate *priv = request->priv;
+	g_autoptr(PkResults) results = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(PkError) error_code = NULL;
+	g_autoptr(GPtrArray) array = NULL;
+	PkDetails *item;
+	GtkWindow *window;
+	const gchar *package_id;
+	guint i;
+
+	/* get the results */
+	results = pk_client_generic_finish (client, res, &error);
+	if (results == NULL) {
+		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+			g_debug ("%s request superseded", gpk_application_request_kind_to_string (request->kind));
+			return;
+		}
+		g_warning ("failed to get details: %s", error->message);
+		return;
+	}
+
+	/* check error code */
+	error_code = pk_results_get_error_code (results);
+	if (error_code != NULL) {
+		g_warning ("failed to get details: %s, %s", pk_error_enum_to_string (pk_error_get_code (error_code)), pk_error_get_details (error_code));
+
+		/* if obvious message, or only a prefetch, don't tell the user */
+		if (pk_error_get_code (error_code) != PK_ERROR_ENUM_TRANSACTION_CANCELLED &&
+		    request->kind == GPK_APPLICATION_REQUEST_DETAILS) {
+			window = GTK_WINDOW (gtk_builder_get_object (priv->builder, "window_manager"));
+			gpk_error_dialog_modal (window, gpk_error_enum_to_localised_text (pk_error_get_code (error_code)),
+						gpk_error_enum_to_localised_message (pk_error_get_code (error_code)), pk_error_get_details (error_code));
+		}
+		return;
+	}
+
+	/* save all of them, and show the one that is selected */
+	array = pk_results_get_details_array (results);
+	g_debug ("got details for %u of %u packages",
+		 array->len, g_strv_length (request->package_ids));
+	for (i = 0; i < array->len; i++) {
+		item = g_ptr_array_index (array, i);
+		package_id = pk_details_get_package_id (item);
+		if (package_id == NULL)
+			continue;
+		gpk_application_cache_insert (priv->details_cache, package_id, g_object_ref (item));
+		if (g_strcmp0 (package_id, priv->details_package_id) == 0)
+			gpk_application_show_details (priv, item);
+	}
+}
+
+static void
+gpk_application_get_details_cb (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request_data)
+{
+	g_autoptr(GpkApplicationRequest) request = request_data;
+	gpk_application_get_details_process (client, res, request);
+	gpk_application_request_finished (request);
+}
+
+/* only asks for the details we don't have and are not already waiting for */
+static gboolean
+gpk_application_request_filter_details (GpkApplicationRequest *request)
+{
+	GpkApplicationPrivate *priv = request->priv;
+	const gchar *package_id;
+	g_autoptr(GPtrArray) array = NULL;
+	guint i;
+
+	array = g_ptr_array_new_with_free_func (g_free);
+	for (i = 0; request->package_ids[i] != NULL; i++) {
+		package_id = request->package_ids[i];
+		if (gpk_application_cache_contains (priv->details_cache, package_id))
+			continue;
+		if (g_hash_table_contains (priv->details_pending, package_id))
+			continue;
+		g_hash_table_insert (priv->details_pending, g_strdup (package_id), request);
+		g_ptr_array_add (array, g_strdup (package_id));
+	}
+	if (array->len == 0)
+		return FALSE;
+	g_ptr_array_add (array, NULL);
+	g_strfreev (request->package_ids);
+	request->package_ids = (gchar **) g_ptr_array_free (g_steal_pointer (&array), FALSE);
+	return TRUE;
+}
+
+static void
+gpk_application_request_start (GpkApplicationRequest *request)
+{
+	GpkApplicationPrivate *priv = request->priv;
+
+	/* nothing left to ask for */
+	if ((request->kind == GPK_APPLICATION_REQUEST_DETAILS ||
+	     request->kind == GPK_APPLICATION_REQUEST_PREFETCH) &&
+	    !gpk_application_request_filter_details (request)) {
+		gpk_application_request_free (request);
+		return;
+	}
+	if (request->kind == GPK_APPLICATION_REQUEST_GROUP_PREFETCH &&
+	    gpk_application_cache_contains (priv->search_cache, request->search_key)) {
+		gpk_application_request_free (request);
+		return;
+	}
+	if (request->kind == GPK_APPLICATION_REQUEST_CATALOG &&
+	    (priv->catalog_index != NULL || priv->catalog_building)) {
+		gpk_application_request_free (request);
+		return;
+	}
+
+	if (request->package_ids != NULL) {
+		g_debug ("starting %s request for %u packages",
+			 gpk_application_request_kind_to_string (request->kind),
+			 g_strv_length (request->package_ids));
+	} else if (request->group != NULL) {
+		g_debug ("starting %s request for %s",
+			 gpk_application_request_kind_to_string (request->kind),
+			 request->group);
+	} else {
+		g_debug ("starting %s request",
+			 gpk_application_request_kind_to_string (request->kind));
+	}
+	g_ptr_array_add (priv->requests_running, request);
+	switch (request->kind) {
+	case GPK_APPLICATION_REQUEST_DETAILS:
+		pk_client_get_details_async (PK_CLIENT (priv->task), request->package_ids, request->cancellable,
+					     (PkProgressCallback) gpk_application_progress_cb, priv,
+					     (GAsyncReadyCallback) gpk_application_get_details_cb, request);
+		break;
+	case GPK_APPLICATION_REQUEST_PREFETCH:
+		/* in the background, so don't show progress */
+		pk_client_get_details_async (PK_CLIENT (priv->task), request->package_ids, request->cancellable,
+					     NULL, NULL,
+					     (GAsyncReadyCallback) gpk_application_get_details_cb, request);
+		break;
+	case GPK_APPLICATION_REQUEST_FILES:
+		pk_client_get_files_async (PK_CLIENT (priv->task), request->package_ids, request->cancellable,
+					   (PkProgressCallback) gpk_application_progress_cb, priv,
+					   (GAsyncReadyCallback) gpk_application_get_files_cb, request);
+		break;
+	case GPK_APPLICATION_REQUEST_REQUIRES:
+		pk_client_depends_on_async (PK_CLIENT (priv->task),
+					    pk_bitfield_value (PK_FILTER_ENUM_NONE),
+					    request->package_ids, TRUE, request->cancellable,
+					    (PkProgressCallback) gpk_application_progress_cb, priv,
+					    (GAsyncReadyCallback) gpk_application_get_depends_cb, request);
+		break;
+	case GPK_APPLICATION_REQUEST_DEPENDS:
+		pk_client_required_by_async (PK_CLIENT (priv->task),
+					     pk_bitfield_value (PK_FILTER_ENUM_NONE),
+					     request->package_ids, TRUE, request->cancellable,
+					     (PkProgressCallback) gpk_application_progress_cb, priv,
+					     (GAsyncReadyCallback) gpk_application_get_requires_cb, request);
+		break;
+	case GPK_APPLICATION_REQUEST_GROUP_PREFETCH:
+		/* in the background, so don't show progress */
+		if (g_strcmp0 (request->group, "all-packages") == 0) {
+			pk_client_get_packages_async (PK_CLIENT (priv->task),
+						      gpk_application_get_backend_filters (priv), request->cancellable,
+						      NULL, NULL,
+						      (GAsyncReadyCallback) gpk_application_group_prefetch_cb, request);
+		} else {
+			g_auto(GStrv) search_groups = g_strsplit (request->group, " ", -1);
+			pk_client_search_groups_async (PK_CLIENT (priv->task),
+						       gpk_application_get_backend_filters (priv), search_groups, request->cancellable,
+						       NULL, NULL,
+						       (GAsyncReadyCallback) gpk_application_group_prefetch_cb, request);
+		}
+		break;
+	case GPK_APPLICATION_REQUEST_CATALOG:
+		/* every package the backend knows about, whatever the filters */
+		pk_client_get_packages_async (PK_CLIENT (priv->task),
+					      pk_bitfield_value (PK_FILTER_ENUM_NONE), request->cancellable,
+					      NULL, NULL,
+					      (GAsyncReadyCallback) gpk_application_catalog_cb, request);
+		break;
+	default:
+		g_assert_not_reached ();
+	}
+}
+
+static gboolean
+gpk_application_requests_dispatch_cb (gpointer user_data)
+{
+	GpkApplicationPrivate *priv = (GpkApplicationPrivate *) user_data;
+	GpkApplicationRequest *request;
+
+	priv->requests_id = 0;
+	while ((request = g_queue_peek_head (priv->requests_queued)) != NULL) {
+		/* prefetching waits for searches and anything the user asked for */
+		if (request->kind >= GPK_APPLICATION_REQUEST_PREFETCH &&
+		    (priv->search_in_progress || priv->requests_running->len > 0))
+			break;
+		g_queue_pop_head (priv->requests_queued);
+		gpk_application_request_start (request);
+	}
+	return G_SOURCE_REMOVE;
+}
+
+/* restarting the delay merges a burst of selection changes into one request */
+static void
+gpk_application_requests_schedule (GpkApplicationPrivate *priv, guint delay)
+{
+	if (priv->requests_id != 0)
+		g_source_remove (priv->requests_id);
+	priv->requests_id = g_timeout_add (delay, gpk_application_requests_dispatch_cb, priv);
+	g_source_set_name_by_id (priv->requests_id, "[GpkApplication] requests");
+}
+
+static gint
+gpk_application_request_compare_func (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	const GpkApplicationRequest *request_a = a;
+	const GpkApplicationRequest *request_b = b;
+	return (gint) request_a->kind - (gint) request_b->kind;
+}
+
+/* use GPK_APPLICATION_REQUEST_LAST for all kinds */
+static void
+gpk_application_requests_cancel (GpkApplicationPrivate *priv, GpkApplicationRequestKind kind)
+{
+	GpkApplicationRequest *request;
+	GList *l;
+	GList *next;
+	guint i;
+
+	for (l = priv->requests_queued->head; l != NULL; l = next) {
+		next = l->next;
+		request = l->data;
+		if (kind != GPK_APPLICATION_REQUEST_LAST && request->kind != kind)
+			continue;
+		g_queue_delete_link (priv->requests_queued, l);
+		gpk_application_request_free (request);
+	}
+	for (i = 0; i < priv->requests_running->len; i++) {
+		request = g_ptr_array_index (priv->requests_running, i);
+		if (kind != GPK_APPLICATION_REQUEST_LAST && request->kind != kind)
+			continue;
+		gpk_application_request_cancel (request);
+	}
+}
+
+static void
+gpk_application_requests_add (GpkApplicationPrivate *priv,
+			      GpkApplicationRequestKind kind,
+			      gchar **package_ids)
+{
+	GpkApplicationRequest *request;
+	GList *l;
+	GList *next;
+	guint i;
+
+	/* anything of the same kind that has not been sent yet is stale */
+	for (l = priv->requests_queued->head; l != NULL; l = next) {
+		next = l->next;
+		request = l->data;
+		if (request->kind != kind)
+			continue;
+		g_debug ("dropping stale %s request", gpk_application_request_kind_to_string (kind));
+		g_queue_delete_link (priv->requests_queued, l);
+		gpk_application_request_free (request);
+	}
+
+	/* a new selection supersedes what is running, unless it is
+	 * already fetching what we want now */
+	for (i = 0; kind != GPK_APPLICATION_REQUEST_PREFETCH && i < priv->requests_running->len; i++) {
+		request = g_ptr_array_index (priv->requests_running, i);
+		if (request->kind != kind)
+			continue;
+		if (g_cancellable_is_cancelled (request->cancellable))
+			continue;
+		if (kind == GPK_APPLICATION_REQUEST_DETAILS &&
+		    g_strv_contains ((const gchar * const *) request->package_ids, package_ids[0]))
+			continue;
+		gpk_application_request_cancel (request);
+	}
+
+	/* warming groups can take a long time, so get out of the way */
+	if (kind < GPK_APPLICATION_REQUEST_PREFETCH) {
+		gpk_application_requests_cancel (priv, GPK_APPLICATION_REQUEST_GROUP_PREFETCH);
+		gpk_application_requests_cancel (priv, GPK_APPLICATION_REQUEST_CATALOG);
+	}
+
+	request = gpk_application_request_new (priv, kind, package_ids);
+	g_queue_insert_sorted (priv->requests_queued, request,
+			       gpk_application_request_compare_func, NULL);
+	gpk_application_requests_schedule (priv, GPK_APPLICATION_REQUEST_DELAY);
+}
+
+static void
+gpk_application_group_prefetch_process (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request)
+{
+	GpkApplicationPrivate *priv = request->priv;
+	g_autoptr(PkResults) results = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(PkError) error_code = NULL;
+	g_autoptr(GPtrArray) array = NULL;
+
+	/* get the results */
+	results = pk_client_generic_finish (client, res, &error);
+	if (results == NULL) {
+		g_debug ("failed to prefetch %s: %s", request->group, error->message);
+		return;
+	}
+
+	/* not worth telling the user about */
+	error_code = pk_results_get_error_code (results);
+	if (error_code != NULL) {
+		g_debug ("failed to prefetch %s: %s, %s", request->group,
+			 pk_error_enum_to_string (pk_error_get_code (error_code)),
+			 pk_error_get_details (error_code));
+		return;
+	}
+
+	/* ready for when the group is clicked */
+	array = pk_results_get_package_array (results);
+	g_debug ("prefetched %u packages for %s", array->len, request->group);
+	gpk_application_catalog_save (priv, request->search_key, array);
+	gpk_application_cache_insert (priv->search_cache, request->search_key,
+				      g_steal_pointer (&array));
+}
+
+static void
+gpk_application_group_prefetch_cb (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request_data)
+{
+	g_autoptr(GpkApplicationRequest) request = request_data;
+	gpk_application_group_prefetch_process (client, res, request);
+	gpk_application_request_finished (request);
+}
+
+static void
+gpk_application_catalog_index_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	GpkApplicationPrivate *priv = (GpkApplicationPrivate *) user_data;
+	g_autoptr(GError) error = NULL;
+	GpkTrigramIndex *index;
 
-		/* actually do the search */
-		gpk_application_perform_search (priv);
+	priv->catalog_building = FALSE;
+	index = gpk_trigram_index_new_finish (res, &error);
+	if (index == NULL) {
+		g_warning ("failed to index packages: %s", error->message);
+		return;
 	}
+	g_debug ("indexed %u words", gpk_trigram_index_get_size (index));
+	g_clear_object (&priv->catalog_index);
+	priv->catalog_index = index;
 }
 
 static void
-gpk_application_get_details_cb (PkClient *client, GAsyncResult *res, GpkApplicationPrivate *priv)
+gpk_application_catalog_process (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request)
 {
+	GpkApplicationPrivate *priv = request->priv;
 	g_autoptr(PkResults) results = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(PkError) error_code = NULL;
 	g_autoptr(GPtrArray) array = NULL;
-	PkDetails *item;
-	GtkWidget *widget;
-	gchar *value;
-	const gchar *repo_name;
-	gboolean installed;
-	g_auto(GStrv) split = NULL;
-	GtkWindow *window;
-	g_autofree gchar *package_id = NULL;
-	g_autofree gchar *url = NULL;
-	PkGroupEnum group;
-	g_autofree gchar *license = NULL;
-	g_autofree gchar *description = NULL;
-	guint64 size;
+	g_autofree gchar *search_key = NULL;
 
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
 	if (results == NULL) {
-		g_warning ("failed to get list of categories: %s", error->message);
+		g_debug ("failed to get catalog: %s", error->message);
 		return;
 	}
 
-	/* check error code */
+	/* not worth telling the user about */
 	error_code = pk_results_get_error_code (results);
 	if (error_code != NULL) {
-		g_warning ("failed to get details: %s, %s", pk_error_enum_to_string (pk_error_get_code (error_code)), pk_error_get_details (error_code));
-
-		/* if obvious message, don't tell the user */
-		if (pk_error_get_code (error_code) != PK_ERROR_ENUM_TRANSACTION_CANCELLED) {
-			window = GTK_WINDOW (gtk_builder_get_object (priv->builder, "window_manager"));
-			gpk_error_dialog_modal (window, gpk_error_enum_to_localised_text (pk_error_get_code (error_code)),
-						gpk_error_enum_to_localised_message (pk_error_get_code (error_code)), pk_error_get_details (error_code));
-		}
+		g_debug ("failed to get catalog: %s, %s",
+			 pk_error_enum_to_string (pk_error_get_code (error_code)),
+			 pk_error_get_details (error_code));
 		return;
 	}
 
-	/* get data */
-	array = pk_results_get_details_array (results);
-	if (array->len != 1) {
-		g_warning ("not one entry %u", array->len);
-		return;
-	}
+	/* the words are split out in a thread */
+	array = pk_results_get_package_array (results);
+	g_debug ("got %u packages for the catalog", array->len);
+	search_key = gpk_application_get_search_key_full (GPK_MODE_ALL_PACKAGES, GPK_SEARCH_UNKNOWN,
+							  pk_bitfield_value (PK_FILTER_ENUM_NONE), NULL);
+	gpk_application_catalog_save (priv, search_key, array);
+	priv->catalog_building = TRUE;
+	gpk_trigram_index_new_async (array, NULL, gpk_application_catalog_index_cb, priv);
+}
 
-	/* only choose the first item */
-	item = g_ptr_array_index (array, 0);
+static void
+gpk_application_catalog_cb (PkClient *client, GAsyncResult *res, GpkApplicationRequest *request_data)
+{
+	g_autoptr(GpkApplicationRequest) request = request_data;
+	gpk_application_catalog_process (client, res, request);
+	gpk_application_request_finished (request);
+}
 
-	/* show to start */
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "grid_details"));
-	gtk_widget_show (widget);
+static gboolean
+gpk_application_requests_has_kind (GpkApplicationPrivate *priv, GpkApplicationRequestKind kind)
+{
+	GpkApplicationRequest *request;
+	GList *l;
+	guint i;
 
-	/* get data */
-	g_object_get (item,
-		      "package-id", &package_id,
-		      "url", &url,
-		      "group", &group,
-		      "license", &license,
-		      "description", &description,
-		      "size", &size,
-		      NULL);
+	for (l = priv->requests_queued->head; l != NULL; l = l->next) {
+		request = l->data;
+		if (request->kind == kind)
+			return TRUE;
+	}
+	for (i = 0; i < priv->requests_running->len; i++) {
+		request = g_ptr_array_index (priv->requests_running, i);
+		if (request->kind == kind &&
+		    !g_cancellable_is_cancelled (request->cancellable))
+			return TRUE;
+	}
+	return FALSE;
+}
 
-	split = pk_package_id_split (package_id);
-	installed = g_str_has_prefix (split[PK_PACKAGE_ID_DATA], "installed");
+/* a one-off snapshot of the package names, for when a search finds nothing */
+static void
+gpk_application_catalog_prefetch (GpkApplicationPrivate *priv)
+{
+	GpkApplicationRequest *request;
 
-	/* homepage */
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "button_homepage"));
-	g_free (priv->homepage_url);
-	priv->homepage_url = g_strdup (url);
-	gtk_widget_set_visible (widget, url != NULL);
+	if (!pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_GET_PACKAGES))
+		return;
+	if (priv->catalog_index != NULL || priv->catalog_building)
+		return;
+	if (gpk_application_requests_has_kind (priv, GPK_APPLICATION_REQUEST_CATALOG))
+		return;
+	request = gpk_application_request_new (priv, GPK_APPLICATION_REQUEST_CATALOG, NULL);
+	g_queue_insert_sorted (priv->requests_queued, request,
+			       gpk_application_request_compare_func, NULL);
+}
 
-	/* licence */
-	if (license != NULL) {
-		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_licence_title"));
-		gtk_widget_show (widget);
-		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_licence"));
-		gtk_label_set_label (GTK_LABEL (widget), license);
-		gtk_label_set_line_wrap (GTK_LABEL (widget), TRUE);
-		gtk_widget_show (widget);
-	} else {
-		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_licence_title"));
-		gtk_widget_hide (widget);
-		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_licence"));
-		gtk_widget_hide (widget);
+static gboolean
+gpk_application_requests_has_group (GpkApplicationPrivate *priv, const gchar *group)
+{
+	GpkApplicationRequest *request;
+	GList *l;
+	guint i;
+
+	for (l = priv->requests_queued->head; l != NULL; l = l->next) {
+		request = l->data;
+		if (g_strcmp0 (request->group, group) == 0)
+			return TRUE;
 	}
+	for (i = 0; i < priv->requests_running->len; i++) {
+		request = g_ptr_array_index (priv->requests_running, i);
+		if (g_strcmp0 (request->group, group) == 0 &&
+		    !g_cancellable_is_cancelled (request->cancellable))
+			return TRUE;
+	}
+	return FALSE;
+}
 
-	/* set the description */
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "textview_description"));
-	gpk_application_set_text_buffer (widget, description);
+static gint
+gpk_application_group_usage_sort_cb (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	GHashTable *group_usage = (GHashTable *) user_data;
+	guint count_a = GPOINTER_TO_UINT (g_hash_table_lookup (group_usage, a));
+	guint count_b = GPOINTER_TO_UINT (g_hash_table_lookup (group_usage, b));
+	if (count_a == count_b)
+		return g_strcmp0 (a, b);
+	return count_a > count_b ? -1 : 1;
+}
 
-	/* if non-zero, set the size */
-	if (size > 0) {
-		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_size_title"));
-		/* set the size */
-		if (g_strcmp0 (split[PK_PACKAGE_ID_DATA], "meta") == 0) {
-			/* TRANSLATORS: the size of the meta package */
-			gtk_label_set_label (GTK_LABEL (widget), _("Size"));
-		} else if (installed) {
-			/* TRANSLATORS: the installed size in bytes of the package */
-			gtk_label_set_label (GTK_LABEL (widget), _("Installed size"));
+/* queues the most used groups that are not already in the search cache */
+static void
+gpk_application_groups_prefetch (GpkApplicationPrivate *priv)
+{
+	GpkApplicationRequest *request;
+	GpkSearchMode mode;
+	const gchar *group;
+	GList *l;
+	guint n = 0;
+	g_autoptr(GList) groups = NULL;
+
+	groups = g_hash_table_get_keys (priv->group_usage);
+	groups = g_list_sort_with_data (groups, gpk_application_group_usage_sort_cb,
+					priv->group_usage);
+	for (l = groups; l != NULL && n < GPK_APPLICATION_GROUP_PREFETCH_MAX; l = l->next) {
+		g_autofree gchar *search_key = NULL;
+
+		group = l->data;
+		if (g_strcmp0 (group, "all-packages") == 0) {
+			if (!pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_GET_PACKAGES))
+				continue;
+			mode = GPK_MODE_ALL_PACKAGES;
 		} else {
-			/* TRANSLATORS: the download size of the package */
-			gtk_label_set_label (GTK_LABEL (widget), _("Download size"));
+			if (!pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_SEARCH_GROUP))
+				continue;
+			mode = GPK_MODE_GROUP;
 		}
-		gtk_widget_show (widget);
-		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_size"));
-		value = g_format_size (size);
-		gtk_label_set_label (GTK_LABEL (widget), value);
-		gtk_widget_show (widget);
-		g_free (value);
-	} else {
-		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_size_title"));
-		gtk_widget_hide (widget);
-		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_size"));
-		gtk_widget_hide (widget);
+		n++;
+
+		/* already warm, or about to be */
+		search_key = gpk_application_get_search_key_full (mode, GPK_SEARCH_UNKNOWN,
+								  gpk_application_get_backend_filters (priv),
+								  mode == GPK_MODE_GROUP ? group : NULL);
+		if (gpk_application_cache_contains (priv->search_cache, search_key))
+			continue;
+		if (gpk_application_requests_has_group (priv, group))
+			continue;
+
+		request = gpk_application_request_new (priv, GPK_APPLICATION_REQUEST_GROUP_PREFETCH, NULL);
+		request->group = g_strdup (group);
+		request->search_key = g_steal_pointer (&search_key);
+		g_queue_insert_sorted (priv->requests_queued, request,
+				       gpk_application_request_compare_func, NULL);
 	}
+	gpk_application_catalog_prefetch (priv);
+	if (priv->requests_id == 0 && !g_queue_is_empty (priv->requests_queued))
+		gpk_application_requests_schedule (priv, 0);
+}
 
-	/* set the repo text */
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "label_source"));
-	/* get the full name of the repo from the repo_id */
-	repo_name = gpk_application_get_full_repo_name (priv, split[PK_PACKAGE_ID_DATA]);
-	gtk_label_set_label (GTK_LABEL (widget), repo_name);
+static gboolean
+gpk_application_groups_prefetch_cb (gpointer user_data)
+{
+	GpkApplicationPrivate *priv = (GpkApplicationPrivate *) user_data;
+	priv->group_prefetch_id = 0;
+	gpk_application_groups_prefetch (priv);
+	return G_SOURCE_REMOVE;
+}
+
+/* restarted by every search, so this only runs when the user stops */
+static void
+gpk_application_groups_prefetch_schedule (GpkApplicationPrivate *priv)
+{
+	if (priv->group_prefetch_id > 0)
+		g_source_remove (priv->group_prefetch_id);
+	priv->group_prefetch_id =
+		g_timeout_add_seconds (GPK_APPLICATION_GROUP_PREFETCH_DELAY,
+				       gpk_application_groups_prefetch_cb, priv);
+	g_source_set_name_by_id (priv->group_prefetch_id,
+				 "[GpkApplication] group-prefetch");
+}
+
+/* adds the package-ids of the rows on screen, up to the batch size */
+static void
+gpk_application_add_visible_package_ids (GpkApplicationPrivate *priv, GPtrArray *package_ids)
+{
+	GtkTreeView *treeview;
+	GtkTreePath *start;
+	GtkTreePath *end;
+	GtkTreeIter iter;
+	PkPackage *package;
+	gint i;
+	gint last;
+
+	treeview = GTK_TREE_VIEW (gtk_builder_get_object (priv->builder, "treeview_packages"));
+	if (!gtk_tree_view_get_visible_range (treeview, &start, &end))
+		return;
+	i = gtk_tree_path_get_indices (start)[0];
+	last = gtk_tree_path_get_indices (end)[0];
+	gtk_tree_path_free (start);
+	gtk_tree_path_free (end);
+
+	for (; i <= last && package_ids->len < GPK_APPLICATION_DETAILS_BATCH_SIZE; i++) {
+		if (!gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (priv->packages_store), &iter, NULL, i))
+			break;
+		package = gpk_package_model_get_package (priv->packages_store, &iter);
+		if (package == NULL)
+			continue;
+		if (gpk_application_cache_contains (priv->details_cache, pk_package_get_id (package)))
+			continue;
+		g_ptr_array_add (package_ids, (gpointer) pk_package_get_id (package));
+	}
+}
+
+static gboolean
+gpk_application_details_prefetch_cb (gpointer user_data)
+{
+	GpkApplicationPrivate *priv = (GpkApplicationPrivate *) user_data;
+	g_autoptr(GPtrArray) package_ids = g_ptr_array_new ();
+
+	priv->details_prefetch_id = 0;
+	gpk_application_add_visible_package_ids (priv, package_ids);
+	if (package_ids->len == 0)
+		return G_SOURCE_REMOVE;
+	g_ptr_array_add (package_ids, NULL);
+	gpk_application_requests_add (priv, GPK_APPLICATION_REQUEST_PREFETCH,
+				      (gchar **) package_ids->pdata);
+	return G_SOURCE_REMOVE;
+}
+
+/* wait for scrolling to settle before asking for what is on screen */
+static void
+gpk_application_details_prefetch (GpkApplicationPrivate *priv)
+{
+	if (priv->details_prefetch_id != 0)
+		g_source_remove (priv->details_prefetch_id);
+	priv->details_prefetch_id =
+		g_timeout_add (GPK_APPLICATION_DETAILS_PREFETCH_DELAY,
+			       gpk_application_details_prefetch_cb, priv);
+	g_source_set_name_by_id (priv->details_prefetch_id,
+				 "[GpkApplication] details-prefetch");
 }
 
 static void
@@ -1923,7 +3783,8 @@ gpk_application_packages_treeview_clicked_cb (GtkTreeSelection *selection, GpkAp
 	gboolean show_install = TRUE;
 	gboolean show_remove = TRUE;
 	PkBitfield state;
-	g_auto(GStrv) package_ids = NULL;
+	PkDetails *details;
+	g_autoptr(GPtrArray) package_ids = NULL;
 	g_autofree gchar *package_id = NULL;
 	g_autofree gchar *summary = NULL;
 
@@ -1948,9 +3809,9 @@ gpk_application_packages_treeview_clicked_cb (GtkTreeSelection *selection, GpkAp
 
 	/* check we aren't a help line */
 	gtk_tree_model_get (model, &iter,
-			    PACKAGES_COLUMN_STATE, &state,
-			    PACKAGES_COLUMN_ID, &package_id,
-			    PACKAGES_COLUMN_SUMMARY, &summary,
+			    GPK_PACKAGE_MODEL_COLUMN_STATE, &state,
+			    GPK_PACKAGE_MODEL_COLUMN_ID, &package_id,
+			    GPK_PACKAGE_MODEL_COLUMN_SUMMARY, &summary,
 			    -1);
 	if (package_id == NULL) {
 		g_debug ("ignoring help click");
@@ -1975,18 +3836,26 @@ gpk_application_packages_treeview_clicked_cb (GtkTreeSelection *selection, GpkAp
 	gpk_application_allow_install (priv, show_install);
 	gpk_application_allow_remove (priv, show_remove);
 
+	/* already seen, so no need to ask the daemon */
+	g_free (priv->details_package_id);
+	priv->details_package_id = g_strdup (package_id);
+	details = gpk_application_cache_lookup (priv->details_cache, package_id);
+	if (details != NULL) {
+		gpk_application_show_details (priv, details);
+		return;
+	}
+
 	/* clear the description text */
 	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "textview_description"));
 	gpk_application_set_text_buffer (widget, NULL);
 
-	/* ensure new action succeeds */
-	g_cancellable_reset (priv->cancellable);
-
-	/* get the details */
-	package_ids = pk_package_ids_from_id (package_id);
-	pk_client_get_details_async (PK_CLIENT(priv->task), package_ids, priv->cancellable,
-				     (PkProgressCallback) gpk_application_progress_cb, priv,
-				     (GAsyncReadyCallback) gpk_application_get_details_cb, priv);
+	/* get the details, and for the neighbours in the same transaction */
+	package_ids = g_ptr_array_new ();
+	g_ptr_array_add (package_ids, package_id);
+	gpk_application_add_visible_package_ids (priv, package_ids);
+	g_ptr_array_add (package_ids, NULL);
+	gpk_application_requests_add (priv, GPK_APPLICATION_REQUEST_DETAILS,
+				      (gchar **) package_ids->pdata);
 }
 
 static void
@@ -2090,6 +3959,29 @@ gpk_application_menu_search_by_file (GtkMenuItem *item, GpkApplicationPrivate *p
 					   "folder-open");
 }
 
+static void
+gpk_application_menu_search_all (GtkMenuItem *item, GpkApplicationPrivate *priv)
+{
+	GtkWidget *widget;
+
+	/* set type */
+	priv->search_type = GPK_SEARCH_ALL;
+	g_debug ("set search type=%u", priv->search_type);
+
+	/* save default to GSettings */
+	g_settings_set_enum (priv->settings,
+			     GPK_SETTINGS_SEARCH_MODE,
+			     priv->search_type);
+
+	/* set the new icon */
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "entry_text"));
+	/* TRANSLATORS: entry tooltip: name, description and file search */
+	gtk_widget_set_tooltip_text (widget, _("Searching all fields"));
+	gtk_entry_set_icon_from_icon_name (GTK_ENTRY (widget),
+					   GTK_ENTRY_ICON_PRIMARY,
+					   "system-search");
+}
+
 static void
 gpk_application_entry_text_icon_press_cb (GtkEntry *entry, GtkEntryIconPosition icon_pos, GdkEventButton *event, GpkApplicationPrivate *priv)
 {
@@ -2126,6 +4018,14 @@ gpk_application_entry_text_icon_press_cb (GtkEntry *entry, GtkEntryIconPosition
 		gtk_menu_shell_append (GTK_MENU_SHELL (menu), item);
 	}
 
+	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_SEARCH_NAME)) {
+		/* TRANSLATORS: context menu item for the search type icon */
+		item = gtk_menu_item_new_with_mnemonic (_("Search all fields"));
+		g_signal_connect (G_OBJECT (item), "activate",
+				  G_CALLBACK (gpk_application_menu_search_all), priv);
+		gtk_menu_shell_append (GTK_MENU_SHELL (menu), item);
+	}
+
 	gtk_widget_show_all (GTK_WIDGET (menu));
 	gtk_menu_popup (GTK_MENU (menu), NULL, NULL, NULL, NULL,
 			event->button, event->time);
@@ -2264,6 +4164,13 @@ gpk_application_refresh_cache_cb (PkClient *client, GAsyncResult *res, GpkApplic
 		}
 		return;
 	}
+
+	/* the package lists are new, so get them again when idle */
+	gpk_application_caches_invalidate (priv);
+	g_clear_object (&priv->catalog_index);
+	gpk_application_catalog_prefetch (priv);
+	if (priv->requests_id == 0 && !g_queue_is_empty (priv->requests_queued))
+		gpk_application_requests_schedule (priv, 0);
 }
 
 static void
@@ -2301,8 +4208,8 @@ gpk_application_package_row_activated_cb (GtkTreeView *treeview, GtkTreePath *pa
 
 	/* get data */
 	gtk_tree_model_get (model, &iter,
-			    PACKAGES_COLUMN_STATE, &state,
-			    PACKAGES_COLUMN_ID, &package_id,
+			    GPK_PACKAGE_MODEL_COLUMN_STATE, &state,
+			    GPK_PACKAGE_MODEL_COLUMN_ID, &package_id,
 			    -1);
 
 	/* check we aren't a help line */
@@ -2328,13 +4235,10 @@ gpk_application_group_row_separator_func (GtkTreeModel *model, GtkTreeIter *iter
 static void
 gpk_application_add_welcome (GpkApplicationPrivate *priv)
 {
-	GtkTreeIter iter;
 	const gchar *welcome;
-	PkBitfield state = 0;
 
 	g_debug ("CLEAR welcome");
 	gpk_application_clear_packages (priv);
-	gtk_list_store_append (priv->packages_store, &iter);
 
 	/* enter something nice */
 	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_SEARCH_GROUP)) {
@@ -2344,15 +4248,7 @@ gpk_application_add_welcome (GpkApplicationPrivate *priv)
 		/* TRANSLATORS: welcome text if we have to search by name */
 		welcome = _("Enter a search word to get started.");
 	}
-	gtk_list_store_set (priv->packages_store, &iter,
-			    PACKAGES_COLUMN_STATE, state,
-			    PACKAGES_COLUMN_CHECKBOX, FALSE,
-			    PACKAGES_COLUMN_CHECKBOX_VISIBLE, FALSE,
-			    PACKAGES_COLUMN_TEXT, welcome,
-			    PACKAGES_COLUMN_IMAGE, "system-search",
-			    PACKAGES_COLUMN_SUMMARY, NULL,
-			    PACKAGES_COLUMN_ID, NULL,
-			    -1);
+	gpk_package_model_add_message (priv->packages_store, "system-search", welcome);
 }
 
 static void
@@ -2361,20 +4257,125 @@ gpk_application_create_group_array_enum (GpkApplicationPrivate *priv)
 	GtkWidget *widget;
 	guint i;
 
-	/* set to no indent */
-	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "treeview_groups"));
-	gtk_tree_view_set_show_expanders (GTK_TREE_VIEW (widget), FALSE);
-	gtk_tree_view_set_level_indentation  (GTK_TREE_VIEW (widget), 0);
-
-	/* create group tree view if we can search by group */
-	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_SEARCH_GROUP)) {
-		/* add all the groups supported (except collections, which we handled above */
-		for (i = 0; i < PK_GROUP_ENUM_LAST; i++) {
-			if (pk_bitfield_contain (priv->groups, i) &&
-			    i != PK_GROUP_ENUM_COLLECTIONS && i != PK_GROUP_ENUM_NEWEST)
-				gpk_application_group_add_data (priv, i);
-		}
+	/* set to no indent */
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "treeview_groups"));
+	gtk_tree_view_set_show_expanders (GTK_TREE_VIEW (widget), FALSE);
+	gtk_tree_view_set_level_indentation  (GTK_TREE_VIEW (widget), 0);
+
+	/* create group tree view if we can search by group */
+	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_SEARCH_GROUP)) {
+		/* add all the groups supported (except collections, which we handled above */
+		for (i = 0; i < PK_GROUP_ENUM_LAST; i++) {
+			if (pk_bitfield_contain (priv->groups, i) &&
+			    i != PK_GROUP_ENUM_COLLECTIONS && i != PK_GROUP_ENUM_NEWEST)
+				gpk_application_group_add_data (priv, i);
+		}
+	}
+}
+
+/* adds the categories below parent_id, and all of theirs */
+static void
+gpk_application_groups_add_categories (GpkApplicationPrivate *priv,
+				       GHashTable *children,
+				       const gchar *parent_id,
+				       GtkTreeIter *parent)
+{
+	g_autoptr(GPtrArray) array = NULL;
+	GtkTreeIter iter;
+	PkCategory *item;
+	guint i;
+
+	/* stolen, so a loop in the parent-ids cannot recurse forever */
+	array = g_hash_table_lookup (children, parent_id);
+	if (array == NULL)
+		return;
+	g_hash_table_steal (children, parent_id);
+	for (i = 0; i < array->len; i++) {
+		item = g_ptr_array_index (array, i);
+		gtk_tree_store_insert_with_values (priv->groups_store, &iter, parent, -1,
+						   GROUPS_COLUMN_NAME, pk_category_get_name (item),
+						   GROUPS_COLUMN_SUMMARY, pk_category_get_summary (item),
+						   GROUPS_COLUMN_ID, pk_category_get_id (item),
+						   GROUPS_COLUMN_ICON, pk_category_get_icon (item),
+						   GROUPS_COLUMN_ACTIVE, parent != NULL,
+						   -1);
+		gpk_application_groups_add_categories (priv, children,
+						       pk_category_get_id (item), &iter);
+	}
+}
+
+static void
+gpk_application_groups_add_category_tree (GpkApplicationPrivate *priv)
+{
+	GPtrArray *array;
+	g_autoptr(GHashTable) cat_ids = NULL;
+	g_autoptr(GHashTable) children = NULL;
+	GPtrArray *siblings;
+	const gchar *parent_id;
+	guint i;
+	GtkTreeView *treeview;
+	PkCategory *item;
+
+	/* set to expanders with indent */
+	treeview = GTK_TREE_VIEW (gtk_builder_get_object (priv->builder, "treeview_groups"));
+	gtk_tree_view_set_show_expanders (treeview, TRUE);
+	gtk_tree_view_set_level_indentation  (treeview, 3);
+
+	/* group by parent, with "" for the top level and for orphans */
+	array = priv->categories;
+	cat_ids = g_hash_table_new (g_str_hash, g_str_equal);
+	for (i = 0; i < array->len; i++) {
+		item = g_ptr_array_index (array, i);
+		if (pk_category_get_id (item) != NULL)
+			g_hash_table_add (cat_ids, (gpointer) pk_category_get_id (item));
+	}
+	children = g_hash_table_new_full (g_str_hash, g_str_equal,
+					  NULL, (GDestroyNotify) g_ptr_array_unref);
+	for (i = 0; i < array->len; i++) {
+		item = g_ptr_array_index (array, i);
+		if (pk_category_get_id (item) == NULL)
+			continue;
+		parent_id = pk_category_get_parent_id (item);
+		if (parent_id == NULL || !g_hash_table_contains (cat_ids, parent_id))
+			parent_id = "";
+		siblings = g_hash_table_lookup (children, parent_id);
+		if (siblings == NULL) {
+			siblings = g_ptr_array_new ();
+			g_hash_table_insert (children, (gpointer) parent_id, siblings);
+		}
+		g_ptr_array_add (siblings, item);
+	}
+	gpk_application_groups_add_categories (priv, children, "", NULL);
+	if (g_hash_table_size (children) > 0)
+		g_debug ("not showing the children of %u parents in a loop",
+			 g_hash_table_size (children));
+
+	/* open all expanders */
+	gtk_tree_view_collapse_all (treeview);
+}
+
+
+static gboolean
+gpk_application_categories_equal (GPtrArray *array1, GPtrArray *array2)
+{
+	PkCategory *item1;
+	PkCategory *item2;
+	guint i;
+
+	/* the cache has no way to tell NULL from empty */
+	if (array1->len != array2->len)
+		return FALSE;
+	for (i = 0; i < array1->len; i++) {
+		item1 = g_ptr_array_index (array1, i);
+		item2 = g_ptr_array_index (array2, i);
+		if (g_strcmp0 (_g_strnull_to_empty (pk_category_get_id (item1)), _g_strnull_to_empty (pk_category_get_id (item2))) != 0 ||
+		    g_strcmp0 (_g_strnull_to_empty (pk_category_get_parent_id (item1)), _g_strnull_to_empty (pk_category_get_parent_id (item2))) != 0 ||
+		    g_strcmp0 (_g_strnull_to_empty (pk_category_get_name (item1)), _g_strnull_to_empty (pk_category_get_name (item2))) != 0 ||
+		    g_strcmp0 (_g_strnull_to_empty (pk_category_get_summary (item1)), _g_strnull_to_empty (pk_category_get_summary (item2))) != 0 ||
+		    g_strcmp0 (_g_strnull_to_empty (pk_category_get_icon (item1)), _g_strnull_to_empty (pk_category_get_icon (item2))) != 0)
+			return FALSE;
 	}
+	return TRUE;
 }
 
 static void
@@ -2384,12 +4385,7 @@ gpk_application_get_categories_cb (PkClient *client, GAsyncResult *res, GpkAppli
 	g_autoptr(GError) error = NULL;
 	g_autoptr(PkError) error_code = NULL;
 	g_autoptr(GPtrArray) array = NULL;
-	GtkTreeIter iter;
-	GtkTreeIter iter2;
-	guint i, j;
-	GtkTreeView *treeview;
-	PkCategory *item;
-	PkCategory *item2;
+	gboolean shown;
 	GtkWindow *window;
 
 	/* get the results */
@@ -2413,75 +4409,36 @@ gpk_application_get_categories_cb (PkClient *client, GAsyncResult *res, GpkAppli
 		return;
 	}
 
-	/* set to expanders with indent */
-	treeview = GTK_TREE_VIEW (gtk_builder_get_object (priv->builder, "treeview_groups"));
-	gtk_tree_view_set_show_expanders (treeview, TRUE);
-	gtk_tree_view_set_level_indentation  (treeview, 3);
-
-	/* add repos with descriptions */
+	/* the cached tree is already shown if it is still correct */
 	array = pk_results_get_category_array (results);
-	for (i = 0; i < array->len; i++) {
-		g_autofree gchar *package_id = NULL;
-		g_autofree gchar *name = NULL;
-		g_autofree gchar *summary = NULL;
-		g_autofree gchar *cat_id = NULL;
-		g_autofree gchar *icon = NULL;
-
-		item = g_ptr_array_index (array, i);
-		g_object_get (item,
-			      "name", &name,
-			      "summary", &summary,
-			      "cat-id", &cat_id,
-			      "icon", &icon,
-			      NULL);
-
-		gtk_tree_store_append (priv->groups_store, &iter, NULL);
-		gtk_tree_store_set (priv->groups_store, &iter,
-				    GROUPS_COLUMN_NAME, name,
-				    GROUPS_COLUMN_SUMMARY, summary,
-				    GROUPS_COLUMN_ID, cat_id,
-				    GROUPS_COLUMN_ICON, icon,
-				    GROUPS_COLUMN_ACTIVE, FALSE,
-				    -1);
-		j = 0;
-		do {
-			g_autofree gchar *cat_id_tmp = NULL;
-			g_autofree gchar *icon_tmp = NULL;
-			g_autofree gchar *name_tmp = NULL;
-			g_autofree gchar *parent_id_tmp = NULL;
-			g_autofree gchar *summary_tmp = NULL;
-
-			/* only allows groups two layers deep */
-			item2 = g_ptr_array_index (array, j);
-			g_object_get (item2,
-				      "parent-id", &parent_id_tmp,
-				      "cat-id", &cat_id_tmp,
-				      "name", &name_tmp,
-				      "summary", &summary_tmp,
-				      "icon", &icon_tmp,
-				      NULL);
-			if (g_strcmp0 (parent_id_tmp, cat_id) == 0) {
-				gtk_tree_store_append (priv->groups_store, &iter2, &iter);
-				gtk_tree_store_set (priv->groups_store, &iter2,
-						    GROUPS_COLUMN_NAME, name_tmp,
-						    GROUPS_COLUMN_SUMMARY, summary_tmp,
-						    GROUPS_COLUMN_ID, cat_id_tmp,
-						    GROUPS_COLUMN_ICON, icon_tmp,
-						    GROUPS_COLUMN_ACTIVE, TRUE,
-						    -1);
-				g_ptr_array_remove (array, item2);
-			} else
-				j++;
-		} while (j < array->len);
+	if (priv->categories != NULL &&
+	    gpk_application_categories_equal (priv->categories, array)) {
+		g_debug ("categories unchanged");
+		return;
 	}
-
-	/* open all expanders */
-	gtk_tree_view_collapse_all (treeview);
+	shown = priv->categories != NULL;
+	if (priv->categories != NULL)
+		g_ptr_array_unref (priv->categories);
+	priv->categories = g_steal_pointer (&array);
+	if (shown)
+		gpk_application_apply_properties (priv);
+	else
+		gpk_application_groups_add_category_tree (priv);
+	gpk_application_startup_cache_save (priv);
 }
 
 static void
 gpk_application_create_group_array_categories (GpkApplicationPrivate *priv)
 {
+	/* show what we had last time straight away */
+	if (priv->categories != NULL)
+		gpk_application_groups_add_category_tree (priv);
+
+	/* and check it against the daemon once */
+	if (priv->categories_requested)
+		return;
+	priv->categories_requested = TRUE;
+
 	/* ensure new action succeeds */
 	g_cancellable_reset (priv->cancellable);
 
@@ -2504,71 +4461,289 @@ gpk_application_key_changed_cb (GSettings *settings, const gchar *key, GpkApplic
 		else
 			gpk_application_create_group_array_enum (priv);
 	} else if (g_strcmp0 (key, "filter-newest") == 0) {
-		/* refresh the search results */
 		if (g_settings_get_boolean (priv->settings, key))
 			pk_bitfield_add (priv->filters_current, PK_FILTER_ENUM_NEWEST);
 		else
 			pk_bitfield_remove (priv->filters_current, PK_FILTER_ENUM_NEWEST);
-		gpk_application_perform_search (priv);
+
+		/* only the backend can show the versions it left out */
+		if (gpk_application_backend_has_newest (priv))
+			gpk_application_perform_search (priv);
+		else
+			gpk_application_results_refilter (priv);
 	} else if (g_strcmp0 (key, "filter-arch") == 0) {
-		/* refresh the search results */
+		/* no need to search again */
 		if (g_settings_get_boolean (priv->settings, key))
 			pk_bitfield_add (priv->filters_current, PK_FILTER_ENUM_ARCH);
 		else
 			pk_bitfield_remove (priv->filters_current, PK_FILTER_ENUM_ARCH);
-		gpk_application_perform_search (priv);
+		gpk_application_results_refilter (priv);
 	}
 }
 
-static void
-pk_backend_status_get_properties_cb (GObject *object, GAsyncResult *res, GpkApplicationPrivate *priv)
+static gchar *
+gpk_application_startup_cache_get_filename (void)
 {
-	GtkWidget *widget;
+	return g_build_filename (g_get_user_cache_dir (), "gnome-packagekit",
+				 "gpk-application.cache", NULL);
+}
+
+/* what the daemon told us last time, so the UI can be built without waiting */
+static gboolean
+gpk_application_startup_cache_load (GpkApplicationPrivate *priv)
+{
+	PkCategory *item;
+	gsize len;
+	guint i;
+	g_autofree gchar *filename = NULL;
 	g_autoptr(GError) error = NULL;
-	PkControl *control = PK_CONTROL(object);
-	gboolean ret;
-	PkBitfield filters;
-	GtkTreeIter iter;
-	const gchar *icon_name;
+	g_autoptr(GKeyFile) keyfile = NULL;
+	g_auto(GStrv) cat_ids = NULL;
+	g_auto(GStrv) descriptions = NULL;
+	g_auto(GStrv) icons = NULL;
+	g_auto(GStrv) names = NULL;
+	g_auto(GStrv) parent_ids = NULL;
+	g_auto(GStrv) repo_ids = NULL;
+	g_auto(GStrv) summaries = NULL;
+	g_auto(GStrv) usage_groups = NULL;
+	g_autofree gint *usage_counts = NULL;
+	gsize counts_len;
+
+	keyfile = g_key_file_new ();
+	filename = gpk_application_startup_cache_get_filename ();
+	if (!g_key_file_load_from_file (keyfile, filename, G_KEY_FILE_NONE, &error)) {
+		g_debug ("no startup cache: %s", error->message);
+		return FALSE;
+	}
+	if (g_key_file_get_integer (keyfile, "gpk-application", "version", NULL) !=
+	    GPK_APPLICATION_STARTUP_CACHE_VERSION) {
+		g_debug ("ignoring startup cache from another version");
+		return FALSE;
+	}
 
-	/* get the result */
-	ret = pk_control_get_properties_finish (control, res, &error);
-	if (!ret) {
-		/* TRANSLATORS: daemon is broken */
-		g_print ("%s: %s\n", _("Exiting as properties could not be retrieved"), error->message);
-		return;
+	/* capabilities */
+	priv->roles = g_key_file_get_uint64 (keyfile, "control", "roles", NULL);
+	priv->filters = g_key_file_get_uint64 (keyfile, "control", "filters", NULL);
+	priv->groups = g_key_file_get_uint64 (keyfile, "control", "groups", NULL);
+
+	/* repo-id to description */
+	repo_ids = g_key_file_get_string_list (keyfile, "repos", "ids", &len, NULL);
+	descriptions = g_key_file_get_string_list (keyfile, "repos", "descriptions", NULL, NULL);
+	if (repo_ids != NULL && descriptions != NULL && g_strv_length (descriptions) == len) {
+		for (i = 0; i < len; i++)
+			g_hash_table_insert (priv->repos, g_strdup (repo_ids[i]), g_strdup (descriptions[i]));
 	}
 
-	/* get values */
-	g_object_get (control,
-		      "roles", &priv->roles,
-		      "filters", &filters,
-		      "groups", &priv->groups,
-		      NULL);
+	/* the category tree, in the order the daemon gave it */
+	if (g_key_file_has_group (keyfile, "categories")) {
+		cat_ids = g_key_file_get_string_list (keyfile, "categories", "ids", &len, NULL);
+		parent_ids = g_key_file_get_string_list (keyfile, "categories", "parent-ids", NULL, NULL);
+		names = g_key_file_get_string_list (keyfile, "categories", "names", NULL, NULL);
+		summaries = g_key_file_get_string_list (keyfile, "categories", "summaries", NULL, NULL);
+		icons = g_key_file_get_string_list (keyfile, "categories", "icons", NULL, NULL);
+		if (cat_ids != NULL && parent_ids != NULL && names != NULL &&
+		    summaries != NULL && icons != NULL &&
+		    g_strv_length (parent_ids) == len && g_strv_length (names) == len &&
+		    g_strv_length (summaries) == len && g_strv_length (icons) == len) {
+			priv->categories = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+			for (i = 0; i < len; i++) {
+				item = pk_category_new ();
+				pk_category_set_id (item, cat_ids[i]);
+				pk_category_set_parent_id (item, _g_strzero (parent_ids[i]) ? NULL : parent_ids[i]);
+				pk_category_set_name (item, names[i]);
+				pk_category_set_summary (item, summaries[i]);
+				pk_category_set_icon (item, _g_strzero (icons[i]) ? NULL : icons[i]);
+				g_ptr_array_add (priv->categories, item);
+			}
+		}
+	}
 
-	/* Remove description/file array if needed. */
-	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_GET_DETAILS) == FALSE) {
-		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "scrolledwindow2"));
-		gtk_widget_hide (widget);
+	/* how often each group has been clicked */
+	usage_groups = g_key_file_get_string_list (keyfile, "usage", "groups", &len, NULL);
+	usage_counts = g_key_file_get_integer_list (keyfile, "usage", "counts", &counts_len, NULL);
+	if (usage_groups != NULL && usage_counts != NULL && counts_len == len) {
+		for (i = 0; i < len; i++) {
+			g_hash_table_insert (priv->group_usage, g_strdup (usage_groups[i]),
+					     GUINT_TO_POINTER (MAX (usage_counts[i], 0)));
+		}
 	}
-	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_GET_FILES) == FALSE) {
-		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "button_files"));
-		gtk_widget_hide (widget);
+
+	priv->startup_cache_data = g_key_file_to_data (keyfile, NULL, NULL);
+	g_debug ("loaded startup cache from %s", filename);
+	return TRUE;
+}
+
+static void
+gpk_application_startup_cache_save (GpkApplicationPrivate *priv)
+{
+	GHashTableIter hash_iter;
+	PkCategory *item;
+	gpointer key;
+	gpointer value;
+	guint i;
+	g_autofree gchar *data = NULL;
+	g_autofree gchar *dirname = NULL;
+	g_autofree gchar *filename = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GKeyFile) keyfile = NULL;
+	g_autoptr(GPtrArray) cat_ids = NULL;
+	g_autoptr(GPtrArray) descriptions = NULL;
+	g_autoptr(GPtrArray) icons = NULL;
+	g_autoptr(GPtrArray) names = NULL;
+	g_autoptr(GPtrArray) parent_ids = NULL;
+	g_autoptr(GPtrArray) repo_ids = NULL;
+	g_autoptr(GPtrArray) summaries = NULL;
+	g_autoptr(GPtrArray) usage_groups = NULL;
+	g_autoptr(GArray) usage_counts = NULL;
+
+	/* don't save anything until the daemon has confirmed it */
+	if (!priv->properties_valid)
+		return;
+
+	keyfile = g_key_file_new ();
+	g_key_file_set_integer (keyfile, "gpk-application", "version",
+				GPK_APPLICATION_STARTUP_CACHE_VERSION);
+	g_key_file_set_uint64 (keyfile, "control", "roles", priv->roles);
+	g_key_file_set_uint64 (keyfile, "control", "filters", priv->filters);
+	g_key_file_set_uint64 (keyfile, "control", "groups", priv->groups);
+
+	/* sorted, so the data only differs when the repos do */
+	repo_ids = g_ptr_array_new ();
+	descriptions = g_ptr_array_new ();
+	g_hash_table_iter_init (&hash_iter, priv->repos);
+	while (g_hash_table_iter_next (&hash_iter, &key, NULL))
+		g_ptr_array_add (repo_ids, key);
+	g_ptr_array_sort (repo_ids, gpk_application_strcmp_cb);
+	for (i = 0; i < repo_ids->len; i++) {
+		value = g_hash_table_lookup (priv->repos, g_ptr_array_index (repo_ids, i));
+		g_ptr_array_add (descriptions, value);
 	}
-	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_DEPENDS_ON) == FALSE) {
-		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "button_depends"));
-		gtk_widget_hide (widget);
+	g_key_file_set_string_list (keyfile, "repos", "ids",
+				    (const gchar * const *) repo_ids->pdata, repo_ids->len);
+	g_key_file_set_string_list (keyfile, "repos", "descriptions",
+				    (const gchar * const *) descriptions->pdata, descriptions->len);
+
+	if (priv->categories != NULL) {
+		cat_ids = g_ptr_array_new ();
+		parent_ids = g_ptr_array_new ();
+		names = g_ptr_array_new ();
+		summaries = g_ptr_array_new ();
+		icons = g_ptr_array_new ();
+		for (i = 0; i < priv->categories->len; i++) {
+			item = g_ptr_array_index (priv->categories, i);
+			g_ptr_array_add (cat_ids, (gpointer) _g_strnull_to_empty (pk_category_get_id (item)));
+			g_ptr_array_add (parent_ids, (gpointer) _g_strnull_to_empty (pk_category_get_parent_id (item)));
+			g_ptr_array_add (names, (gpointer) _g_strnull_to_empty (pk_category_get_name (item)));
+			g_ptr_array_add (summaries, (gpointer) _g_strnull_to_empty (pk_category_get_summary (item)));
+			g_ptr_array_add (icons, (gpointer) _g_strnull_to_empty (pk_category_get_icon (item)));
+		}
+		g_key_file_set_string_list (keyfile, "categories", "ids",
+					    (const gchar * const *) cat_ids->pdata, cat_ids->len);
+		g_key_file_set_string_list (keyfile, "categories", "parent-ids",
+					    (const gchar * const *) parent_ids->pdata, parent_ids->len);
+		g_key_file_set_string_list (keyfile, "categories", "names",
+					    (const gchar * const *) names->pdata, names->len);
+		g_key_file_set_string_list (keyfile, "categories", "summaries",
+					    (const gchar * const *) summaries->pdata, summaries->len);
+		g_key_file_set_string_list (keyfile, "categories", "icons",
+					    (const gchar * const *) icons->pdata, icons->len);
 	}
-	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_REQUIRED_BY) == FALSE) {
-		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "button_requires"));
-		gtk_widget_hide (widget);
+
+	usage_groups = g_ptr_array_new ();
+	usage_counts = g_array_new (FALSE, FALSE, sizeof (gint));
+	g_hash_table_iter_init (&hash_iter, priv->group_usage);
+	while (g_hash_table_iter_next (&hash_iter, &key, NULL))
+		g_ptr_array_add (usage_groups, key);
+	g_ptr_array_sort (usage_groups, gpk_application_strcmp_cb);
+	for (i = 0; i < usage_groups->len; i++) {
+		gint count = GPOINTER_TO_UINT (g_hash_table_lookup (priv->group_usage,
+								    g_ptr_array_index (usage_groups, i)));
+		g_array_append_val (usage_counts, count);
 	}
+	g_key_file_set_string_list (keyfile, "usage", "groups",
+				    (const gchar * const *) usage_groups->pdata, usage_groups->len);
+	g_key_file_set_integer_list (keyfile, "usage", "counts",
+				     (gint *) usage_counts->data, usage_counts->len);
+
+	/* nothing changed */
+	data = g_key_file_to_data (keyfile, NULL, NULL);
+	if (g_strcmp0 (data, priv->startup_cache_data) == 0)
+		return;
 
-	/* hide the group selector if we don't support search-groups */
-	if (pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_SEARCH_GROUP) == FALSE) {
-		widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "scrolledwindow_groups"));
-		gtk_widget_hide (widget);
+	filename = gpk_application_startup_cache_get_filename ();
+	dirname = g_path_get_dirname (filename);
+	if (g_mkdir_with_parents (dirname, 0700) < 0) {
+		g_warning ("failed to create %s", dirname);
+		return;
+	}
+	if (!g_file_set_contents (filename, data, -1, &error)) {
+		g_warning ("failed to save startup cache: %s", error->message);
+		return;
 	}
+	g_debug ("saved startup cache to %s", filename);
+	g_free (priv->startup_cache_data);
+	priv->startup_cache_data = g_steal_pointer (&data);
+}
+
+static gboolean
+gpk_application_startup_cache_save_cb (gpointer user_data)
+{
+	GpkApplicationPrivate *priv = (GpkApplicationPrivate *) user_data;
+	priv->startup_cache_save_id = 0;
+	gpk_application_startup_cache_save (priv);
+	return G_SOURCE_REMOVE;
+}
+
+/* the usage counts change on every group click, so write them in one go */
+static void
+gpk_application_startup_cache_save_schedule (GpkApplicationPrivate *priv)
+{
+	if (priv->startup_cache_save_id > 0)
+		return;
+	priv->startup_cache_save_id =
+		g_timeout_add_seconds (GPK_APPLICATION_STARTUP_CACHE_DELAY,
+				       gpk_application_startup_cache_save_cb, priv);
+	g_source_set_name_by_id (priv->startup_cache_save_id,
+				 "[GpkApplication] startup-cache-save");
+}
+
+/* writes anything still waiting for the timeout */
+static void
+gpk_application_startup_cache_save_flush (GpkApplicationPrivate *priv)
+{
+	if (priv->startup_cache_save_id == 0)
+		return;
+	g_source_remove (priv->startup_cache_save_id);
+	priv->startup_cache_save_id = 0;
+	gpk_application_startup_cache_save (priv);
+}
+
+/* shows the widgets and groups that the backend supports */
+static void
+gpk_application_apply_properties (GpkApplicationPrivate *priv)
+{
+	GtkWidget *widget;
+	gboolean ret;
+	GtkTreeIter iter;
+	const gchar *icon_name;
+
+	/* remove description/file array if needed, this may be run again
+	 * if the daemon disagrees with the cache */
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "scrolledwindow2"));
+	gtk_widget_set_visible (widget, pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_GET_DETAILS));
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "button_files"));
+	gtk_widget_set_visible (widget, pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_GET_FILES));
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "button_depends"));
+	gtk_widget_set_visible (widget, pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_DEPENDS_ON));
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "button_requires"));
+	gtk_widget_set_visible (widget, pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_REQUIRED_BY));
+
+	/* hide the group selector if we don't support search-groups */
+	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "scrolledwindow_groups"));
+	gtk_widget_set_visible (widget, pk_bitfield_contain (priv->roles, PK_ROLE_ENUM_SEARCH_GROUP));
+
+	/* start the sidebar again */
+	gtk_tree_store_clear (priv->groups_store);
 
 	/* add an "all" entry if we can GetPackages */
 	ret = g_settings_get_boolean (priv->settings, GPK_SETTINGS_SHOW_ALL_PACKAGES);
@@ -2604,6 +4779,14 @@ pk_backend_status_get_properties_cb (GObject *object, GAsyncResult *res, GpkAppl
 		gpk_application_create_group_array_categories (priv);
 	else
 		gpk_application_create_group_array_enum (priv);
+}
+
+/* only done once, when we first know what the backend supports */
+static void
+gpk_application_show_properties (GpkApplicationPrivate *priv)
+{
+	priv->properties_shown = TRUE;
+	gpk_application_apply_properties (priv);
 
 	/* set the search mode */
 	priv->search_type = g_settings_get_enum (priv->settings, GPK_SETTINGS_SEARCH_MODE);
@@ -2632,6 +4815,10 @@ pk_backend_status_get_properties_cb (GObject *object, GAsyncResult *res, GpkAppl
 			gpk_application_menu_search_by_name (NULL, priv);
 		}
 
+	/* search everything the backend can */
+	} else if (priv->search_type == GPK_SEARCH_ALL) {
+		gpk_application_menu_search_all (NULL, priv);
+
 	/* mode not recognized */
 	} else {
 		g_warning ("cannot recognize mode %u, using name", priv->search_type);
@@ -2640,6 +4827,61 @@ pk_backend_status_get_properties_cb (GObject *object, GAsyncResult *res, GpkAppl
 
 	/* welcome */
 	gpk_application_add_welcome (priv);
+
+	/* warm the popular groups if the user does nothing */
+	gpk_application_groups_prefetch_schedule (priv);
+}
+
+static void
+pk_backend_status_get_properties_cb (GObject *object, GAsyncResult *res, GpkApplicationPrivate *priv)
+{
+	g_autoptr(GError) error = NULL;
+	PkControl *control = PK_CONTROL(object);
+	gboolean ret;
+	PkBitfield roles;
+	PkBitfield filters;
+	PkBitfield groups;
+	gboolean changed;
+	g_autofree gchar *distro_id = NULL;
+	g_auto(GStrv) split = NULL;
+
+	/* get the result */
+	ret = pk_control_get_properties_finish (control, res, &error);
+	if (!ret) {
+		/* TRANSLATORS: daemon is broken */
+		g_print ("%s: %s\n", _("Exiting as properties could not be retrieved"), error->message);
+		return;
+	}
+
+	/* get values */
+	g_object_get (control,
+		      "roles", &roles,
+		      "filters", &filters,
+		      "groups", &groups,
+		      "distro-id", &distro_id,
+		      NULL);
+
+	/* "name;version;arch", which is what the arch filter keeps */
+	if (distro_id != NULL) {
+		split = g_strsplit (distro_id, ";", -1);
+		if (g_strv_length (split) == 3)
+			gpk_arch_set_native (split[2]);
+	}
+
+	changed = roles != priv->roles || filters != priv->filters || groups != priv->groups;
+	priv->roles = roles;
+	priv->filters = filters;
+	priv->groups = groups;
+	priv->properties_valid = TRUE;
+
+	/* the UI may already have been built from the cache */
+	if (!priv->properties_shown) {
+		gpk_application_show_properties (priv);
+	} else if (changed) {
+		g_debug ("backend properties differ from the cache");
+		gpk_application_apply_properties (priv);
+	}
+	gpk_application_startup_cache_save (priv);
 }
 
 static void
@@ -2674,7 +4916,8 @@ gpk_application_get_repo_list_cb (PkClient *client, GAsyncResult *res, GpkApplic
 		return;
 	}
 
-	/* add repos with descriptions */
+	/* add repos with descriptions, replacing any from the cache */
+	g_hash_table_remove_all (priv->repos);
 	array = pk_results_get_repo_detail_array (results);
 	for (i = 0; i < array->len; i++) {
 		g_autofree gchar *repo_id = NULL;
@@ -2690,6 +4933,7 @@ gpk_application_get_repo_list_cb (PkClient *client, GAsyncResult *res, GpkApplic
 		if (description != NULL)
 			g_hash_table_insert (priv->repos, g_strdup (repo_id), g_strdup (description));
 	}
+	gpk_application_startup_cache_save (priv);
 }
 
 static void
@@ -2710,24 +4954,46 @@ gpk_application_startup_cb (GtkApplication *application, GpkApplicationPrivate *
 	GtkWidget *main_window;
 	GtkWidget *widget;
 	guint retval;
+	const gchar *accels_back[] = { "<Alt>Left", NULL };
+	const gchar *accels_forward[] = { "<Alt>Right", NULL };
+	g_autofree gchar *filename = NULL;
+	g_autoptr(GError) error_catalog = NULL;
 
 	priv->package_sack = pk_package_sack_new ();
+	priv->package_sack_ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 	priv->settings = g_settings_new (GPK_SETTINGS_SCHEMA);
 	priv->cancellable = g_cancellable_new ();
+	priv->search_cancellable = g_cancellable_new ();
 	priv->repos = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	priv->results_package_ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+	priv->results_pending = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	priv->search_results = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	priv->results_ranked = g_array_new (FALSE, FALSE, sizeof (GpkResultsItem));
+	g_array_set_clear_func (priv->results_ranked, (GDestroyNotify) gpk_application_ranked_item_clear);
+	filename = g_build_filename (g_get_user_cache_dir (), "gnome-packagekit",
+				     "gpk-application.catalog", NULL);
+	priv->catalog = gpk_catalog_new (filename);
+	priv->catalog_saves = g_queue_new ();
+	if (!gpk_catalog_load (priv->catalog, &error_catalog))
+		g_debug ("no catalog: %s", error_catalog->message);
+	priv->search_cache = gpk_application_cache_new ("search",
+							GPK_APPLICATION_SEARCH_CACHE_SIZE,
+							(GDestroyNotify) g_ptr_array_unref);
+	priv->details_cache = gpk_application_cache_new ("details",
+							 GPK_APPLICATION_DETAILS_CACHE_SIZE,
+							 (GDestroyNotify) g_object_unref);
+	priv->details_pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	priv->requests_queued = g_queue_new ();
+	priv->requests_running = g_ptr_array_new ();
+	priv->group_usage = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	priv->history_back = g_queue_new ();
+	priv->history_forward = g_queue_new ();
 
 	/* watch gnome-packagekit keys */
 	g_signal_connect (priv->settings, "changed", G_CALLBACK (gpk_application_key_changed_cb), priv);
 
 	/* create array stores */
-	priv->packages_store = gtk_list_store_new (PACKAGES_COLUMN_LAST,
-					      G_TYPE_STRING,
-					      G_TYPE_UINT64,
-					      G_TYPE_BOOLEAN,
-					      G_TYPE_BOOLEAN,
-					      G_TYPE_STRING,
-					      G_TYPE_STRING,
-					      G_TYPE_STRING);
+	priv->packages_store = gpk_application_packages_store_new (priv);
 	priv->groups_store = gtk_tree_store_new (GROUPS_COLUMN_LAST,
 					   G_TYPE_STRING,
 					   G_TYPE_STRING,
@@ -2753,6 +5019,10 @@ gpk_application_startup_cb (GtkApplication *application, GpkApplicationPrivate *
 	pk_control_get_properties_async (priv->control, NULL, (GAsyncReadyCallback) pk_backend_status_get_properties_cb, priv);
 	g_signal_connect (priv->control, "notify::network-state",
 			  G_CALLBACK (gpk_application_notify_network_state_cb), priv);
+	g_signal_connect_swapped (priv->control, "updates-changed",
+				  G_CALLBACK (gpk_application_caches_invalidate), priv);
+	g_signal_connect_swapped (priv->control, "repo-list-changed",
+				  G_CALLBACK (gpk_application_caches_invalidate), priv);
 
 	/* get UI */
 	priv->builder = gtk_builder_new ();
@@ -2775,6 +5045,9 @@ gpk_application_startup_cb (GtkApplication *application, GpkApplicationPrivate *
 	g_action_map_add_action (G_ACTION_MAP (priv->application), action);
 	action = g_settings_create_action (priv->settings, "filter-arch");
 	g_action_map_add_action (G_ACTION_MAP (priv->application), action);
+	gtk_application_set_accels_for_action (application, "app.back", accels_back);
+	gtk_application_set_accels_for_action (application, "app.forward", accels_forward);
+	gpk_application_history_update_actions (priv);
 
 	/* Hide window first so that the dialogue resizes itself without redrawing */
 	gtk_widget_hide (main_window);
@@ -2843,9 +5116,6 @@ gpk_application_startup_cb (GtkApplication *application, GpkApplicationPrivate *
 	g_signal_connect (GTK_EDITABLE (widget), "changed",
 			  G_CALLBACK (gpk_application_text_changed_cb), priv);
 
-	/* mark find button insensitive */
-	gpk_application_set_button_find_sensitivity (priv);
-
 	/* set a size, as much as the screen allows */
 	gtk_window_set_default_size (GTK_WINDOW (main_window), 1000, 600);
 	gtk_widget_show (GTK_WIDGET(main_window));
@@ -2855,9 +5125,10 @@ gpk_application_startup_cb (GtkApplication *application, GpkApplicationPrivate *
 	g_signal_connect (GTK_TREE_VIEW (widget), "row-activated",
 			  G_CALLBACK (gpk_application_package_row_activated_cb), priv);
 
-	/* sorted */
+	/* most relevant first, until a column is clicked */
 	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (priv->packages_store),
-					      PACKAGES_COLUMN_ID, GTK_SORT_ASCENDING);
+					      GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID,
+					      GTK_SORT_ASCENDING);
 
 	/* create package tree view */
 	widget = GTK_WIDGET (gtk_builder_get_object (priv->builder, "treeview_packages"));
@@ -2867,6 +5138,8 @@ gpk_application_startup_cb (GtkApplication *application, GpkApplicationPrivate *
 	selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (widget));
 	g_signal_connect (selection, "changed",
 			  G_CALLBACK (gpk_application_packages_treeview_clicked_cb), priv);
+	g_signal_connect_swapped (gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (widget)), "value-changed",
+				  G_CALLBACK (gpk_application_details_prefetch), priv);
 
 	/* add columns to the tree view */
 	gpk_application_packages_add_columns (priv);
@@ -2903,6 +5176,11 @@ gpk_application_startup_cb (GtkApplication *application, GpkApplicationPrivate *
 
 	/* hide details */
 	gpk_application_clear_details (priv);
+
+	/* build the UI from what the daemon said last time, the real
+	 * properties, categories and repos replace it when they arrive */
+	if (gpk_application_startup_cache_load (priv))
+		gpk_application_show_properties (priv);
 }
 
 static void
@@ -2931,6 +5209,180 @@ gpk_application_activate_updates_cb (GSimpleAction *action,
 
 }
 
+/* the queue may have changed since the list was shown */
+static void
+gpk_application_history_sync_states (GpkApplicationPrivate *priv)
+{
+	GtkTreeModel *model = GTK_TREE_MODEL (priv->packages_store);
+	GtkTreeIter iter;
+	PkPackage *package;
+	PkBitfield state;
+	gboolean in_queue;
+	gboolean valid;
+
+	valid = gtk_tree_model_get_iter_first (model, &iter);
+	for (; valid; valid = gtk_tree_model_iter_next (model, &iter)) {
+		package = gpk_package_model_get_package (priv->packages_store, &iter);
+		if (package == NULL)
+			continue;
+		state = gpk_package_model_get_state (priv->packages_store, &iter);
+		in_queue = gpk_application_queue_contains (priv, pk_package_get_id (package));
+		if (in_queue == pk_bitfield_contain (state, GPK_STATE_IN_LIST))
+			continue;
+		if (in_queue)
+			pk_bitfield_add (state, GPK_STATE_IN_LIST);
+		else
+			pk_bitfield_remove (state, GPK_STATE_IN_LIST);
+		gpk_package_model_set_state (priv->packages_store, &iter, state);
+	}
+}
+
+static gboolean
+gpk_application_history_find_group_cb (GtkTreeModel *model,
+				       GtkTreePath *path,
+				       GtkTreeIter *iter,
+				       gpointer user_data)
+{
+	GpkApplicationPrivate *priv = (GpkApplicationPrivate *) user_data;
+	GtkTreeView *treeview;
+	g_autofree gchar *id = NULL;
+
+	gtk_tree_model_get (model, iter, GROUPS_COLUMN_ID, &id, -1);
+	if (g_strcmp0 (id, priv->search_group) != 0)
+		return FALSE;
+	treeview = GTK_TREE_VIEW (gtk_builder_get_object (priv->builder, "treeview_groups"));
+	gtk_tree_view_expand_to_path (treeview, path);
+	gtk_tree_selection_select_path (gtk_tree_view_get_selection (treeview), path);
+	return TRUE;
+}
+
+/* puts the search box and group selection back without searching again */
+static void
+gpk_application_history_restore_query (GpkApplicationPrivate *priv)
+{
+	GtkEntry *entry;
+	GtkTreeSelection *selection;
+	GtkTreeView *treeview;
+
+	entry = GTK_ENTRY (gtk_builder_get_object (priv->builder, "entry_text"));
+	treeview = GTK_TREE_VIEW (gtk_builder_get_object (priv->builder, "treeview_groups"));
+	selection = gtk_tree_view_get_selection (treeview);
+	g_signal_handlers_block_by_func (entry, gpk_application_text_changed_cb, priv);
+	g_signal_handlers_block_by_func (selection, gpk_application_groups_treeview_changed_cb, priv);
+
+	gtk_tree_selection_unselect_all (selection);
+	if (priv->search_mode == GPK_MODE_NAME_DETAILS_FILE) {
+		gtk_entry_set_text (entry, priv->search_text);
+	} else {
+		gtk_entry_set_text (entry, "");
+		gtk_tree_model_foreach (GTK_TREE_MODEL (priv->groups_store),
+					gpk_application_history_find_group_cb, priv);
+	}
+
+	g_signal_handlers_unblock_by_func (selection, gpk_application_groups_treeview_changed_cb, priv);
+	g_signal_handlers_unblock_by_func (entry, gpk_application_text_changed_cb, priv);
+}
+
+/* swaps a kept list back into the view */
+static void
+gpk_application_history_restore (GpkApplicationPrivate *priv, GpkApplicationHistoryItem *item)
+{
+	GtkTreeView *treeview;
+	g_autoptr(GpkPackageModel) store_old = priv->packages_store;
+	g_autoptr(GHashTable) package_ids_old = priv->results_package_ids;
+
+	priv->packages_store = g_steal_pointer (&item->model);
+	priv->results_package_ids = g_steal_pointer (&item->package_ids);
+	priv->has_package = TRUE;
+
+	/* the filters have changed since, so the rows have moved */
+	if (gpk_package_model_set_filters (priv->packages_store, gpk_application_get_model_filters (priv))) {
+		g_clear_pointer (&item->selected, gtk_tree_path_free);
+		g_clear_pointer (&item->top, gtk_tree_path_free);
+	}
+	gpk_application_history_sync_states (priv);
+
+	/* the query that made the list */
+	priv->search_mode = item->search_mode;
+	g_free (priv->search_group);
+	priv->search_group = g_strdup (item->search_group);
+	g_free (priv->search_text);
+	priv->search_text = g_strdup (item->search_text);
+	g_free (priv->search_key);
+	priv->search_key = gpk_application_get_search_key (priv);
+	if (priv->search_mode == GPK_MODE_NAME_DETAILS_FILE) {
+		priv->refine_text = g_strdup (priv->search_text);
+		priv->refine_filters = gpk_application_get_backend_filters (priv);
+	}
+	gpk_application_history_restore_query (priv);
+
+	/* the view scrolls once it knows how high the rows are */
+	treeview = GTK_TREE_VIEW (gtk_builder_get_object (priv->builder, "treeview_packages"));
+	gtk_tree_view_set_model (treeview, GTK_TREE_MODEL (priv->packages_store));
+	if (item->selected != NULL) {
+		gtk_tree_selection_select_path (gtk_tree_view_get_selection (treeview),
+						item->selected);
+		g_clear_pointer (&item->selected, gtk_tree_path_free);
+	}
+	if (item->top != NULL) {
+		gtk_tree_view_scroll_to_cell (treeview, item->top, NULL, TRUE, 0.f, 0.f);
+		g_clear_pointer (&item->top, gtk_tree_path_free);
+	}
+
+	priv->history_current = item;
+	gpk_application_details_prefetch (priv);
+}
+
+static void
+gpk_application_history_go (GpkApplicationPrivate *priv, GQueue *from, GQueue *to)
+{
+	GpkApplicationHistoryItem *current;
+	GpkApplicationHistoryItem *item;
+
+	item = g_queue_pop_head (from);
+	if (item == NULL)
+		return;
+
+	/* stop whatever the old list was waiting for */
+	if (priv->search_delay_id > 0) {
+		g_source_remove (priv->search_delay_id);
+		priv->search_delay_id = 0;
+	}
+	gpk_application_search_cancel (priv);
+	gpk_application_requests_cancel (priv, GPK_APPLICATION_REQUEST_PREFETCH);
+	gpk_application_requests_cancel (priv, GPK_APPLICATION_REQUEST_GROUP_PREFETCH);
+	gpk_application_clear_details (priv);
+	gpk_application_results_stop (priv);
+
+	/* keep the list we are leaving, if it was finished */
+	current = gpk_application_history_take (priv);
+	if (current != NULL)
+		g_queue_push_head (to, current);
+
+	g_debug ("going to %s", item->search_mode == GPK_MODE_NAME_DETAILS_FILE ?
+		 item->search_text : item->search_group);
+	gpk_application_history_restore (priv, item);
+	gpk_application_history_trim (priv);
+}
+
+static void
+gpk_application_activate_back_cb (GSimpleAction *action,
+				  GVariant *parameter,
+				  gpointer user_data)
+{
+	GpkApplicationPrivate *priv = user_data;
+	gpk_application_history_go (priv, priv->history_back, priv->history_forward);
+}
+
+static void
+gpk_application_activate_forward_cb (GSimpleAction *action,
+				     GVariant *parameter,
+				     gpointer user_data)
+{
+	GpkApplicationPrivate *priv = user_data;
+	gpk_application_history_go (priv, priv->history_forward, priv->history_back);
+}
+
 static GActionEntry gpk_menu_app_entries[] = {
 	{ "updates",		gpk_application_activate_updates_cb, NULL, NULL, NULL },
 	{ "sources",		gpk_application_activate_sources_cb, NULL, NULL, NULL },
@@ -2938,6 +5390,8 @@ static GActionEntry gpk_menu_app_entries[] = {
 	{ "log",		gpk_application_activate_log_cb, NULL, NULL, NULL },
 	{ "quit",		gpk_application_activate_quit_cb, NULL, NULL, NULL },
 	{ "about",		gpk_application_activate_about_cb, NULL, NULL, NULL },
+	{ "back",		gpk_application_activate_back_cb, NULL, NULL, NULL },
+	{ "forward",		gpk_application_activate_forward_cb, NULL, NULL, NULL },
 };
 
 int
@@ -3008,12 +5462,19 @@ main (int argc, char *argv[])
 	/* run */
 	status = g_application_run (G_APPLICATION (priv->application), argc, argv);
 	g_object_unref (priv->application);
+	gpk_application_startup_cache_save_flush (priv);
 
 	if (priv->details_event_id > 0)
 		g_source_remove (priv->details_event_id);
 
 	if (priv->packages_store != NULL)
 		g_object_unref (priv->packages_store);
+	if (priv->catalog_index != NULL)
+		g_object_unref (priv->catalog_index);
+	if (priv->catalog != NULL)
+		g_object_unref (priv->catalog);
+	if (priv->catalog_saves != NULL)
+		g_queue_free_full (priv->catalog_saves, (GDestroyNotify) gpk_application_catalog_save_free);
 	if (priv->control != NULL)
 		g_object_unref (priv->control);
 	if (priv->task != NULL)
@@ -3024,15 +5485,64 @@ main (int argc, char *argv[])
 		g_object_unref (priv->builder);
 	if (priv->cancellable != NULL)
 		g_object_unref (priv->cancellable);
+	if (priv->search_cancellable != NULL)
+		g_object_unref (priv->search_cancellable);
+	if (priv->search_delay_id > 0)
+		g_source_remove (priv->search_delay_id);
 	if (priv->package_sack != NULL)
 		g_object_unref (priv->package_sack);
+	if (priv->package_sack_ids != NULL)
+		g_hash_table_destroy (priv->package_sack_ids);
 	if (priv->repos != NULL)
 		g_hash_table_destroy (priv->repos);
+	if (priv->results_package_ids != NULL)
+		g_hash_table_destroy (priv->results_package_ids);
+	if (priv->results_pending != NULL)
+		g_ptr_array_unref (priv->results_pending);
+	if (priv->results_ranked != NULL)
+		g_array_unref (priv->results_ranked);
+	if (priv->search_results != NULL)
+		g_ptr_array_unref (priv->search_results);
+	if (priv->search_cache != NULL)
+		gpk_application_cache_free (priv->search_cache);
+	if (priv->details_cache != NULL)
+		gpk_application_cache_free (priv->details_cache);
+	if (priv->requests_id > 0)
+		g_source_remove (priv->requests_id);
+	if (priv->group_prefetch_id > 0)
+		g_source_remove (priv->group_prefetch_id);
+	if (priv->group_usage != NULL)
+		g_hash_table_destroy (priv->group_usage);
+	if (priv->history_back != NULL)
+		g_queue_free_full (priv->history_back, (GDestroyNotify) gpk_application_history_item_free);
+	if (priv->history_forward != NULL)
+		g_queue_free_full (priv->history_forward, (GDestroyNotify) gpk_application_history_item_free);
+	if (priv->history_current != NULL)
+		gpk_application_history_item_free (priv->history_current);
+	if (priv->requests_queued != NULL)
+		g_queue_free_full (priv->requests_queued, (GDestroyNotify) gpk_application_request_free);
+	if (priv->requests_running != NULL) {
+		g_ptr_array_set_free_func (priv->requests_running, (GDestroyNotify) gpk_application_request_free);
+		g_ptr_array_unref (priv->requests_running);
+	}
+	if (priv->details_pending != NULL)
+		g_hash_table_destroy (priv->details_pending);
+	if (priv->details_prefetch_id > 0)
+		g_source_remove (priv->details_prefetch_id);
+	if (priv->results_id > 0)
+		g_source_remove (priv->results_id);
 	if (priv->status_id > 0)
 		g_source_remove (priv->status_id);
 	g_free (priv->homepage_url);
 	g_free (priv->search_group);
 	g_free (priv->search_text);
+	g_free (priv->search_key);
+	g_strfreev (priv->search_terms);
+	g_free (priv->refine_text);
+	g_free (priv->details_package_id);
+	g_free (priv->startup_cache_data);
+	if (priv->categories != NULL)
+		g_ptr_array_unref (priv->categories);
 	g_free (priv);
 
 	return status;
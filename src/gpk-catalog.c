@@ -0,0 +1,564 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2007-2013 Richard Hughes <richard@hughsie.com>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <packagekit-glib2/packagekit.h>
+
+#include "gpk-catalog.h"
+
+#define GPK_CATALOG_MAGIC		"GPKCAT\0\0"
+#define GPK_CATALOG_VERSION		2
+#define GPK_CATALOG_MAX_LISTS		32 /* lists */
+
+/*
+ * The package lists the daemon returned last time, kept in one file
+ * that is mapped rather than read, so opening it costs nothing until a
+ * list is actually shown.
+ *
+ * The file is the header, then the lists, then a record for every
+ * package of every list, then the NUL terminated strings that the
+ * lists and records point into. Each string is only stored once.
+ * Numbers are in the byte order of the machine that wrote the file, as
+ * it never leaves the user's cache directory.
+ *
+ * Lists are stored newest first, and the oldest ones are dropped when
+ * there are too many. Saving a list writes a new file and maps it
+ * again, unless the list is already saved as it is. The new file can
+ * be built and written in a thread, as that only needs the old mapping.
+ */
+
+typedef struct {
+	gchar			 magic[8];
+	guint32			 version;
+	guint32			 n_lists;
+	guint32			 n_records;
+	guint32			 strings_size;
+} GpkCatalogHeader;
+
+typedef struct {
+	guint32			 key;		/* string offset */
+	guint32			 first;		/* record index */
+	guint32			 n_records;
+} GpkCatalogList;
+
+typedef struct {
+	guint32			 package_id;	/* string offset */
+	guint32			 summary;	/* string offset */
+	guint32			 info;		/* PkInfoEnum */
+} GpkCatalogRecord;
+
+struct _GpkCatalog
+{
+	GObject			 parent_instance;
+	gchar			*filename;
+	GMappedFile		*mapped;	/* or NULL if there is no file */
+	const GpkCatalogHeader	*header;
+	const GpkCatalogList	*lists;
+	const GpkCatalogRecord	*records;
+	const gchar		*strings;
+};
+
+G_DEFINE_TYPE (GpkCatalog, gpk_catalog, G_TYPE_OBJECT)
+
+static void
+gpk_catalog_unload (GpkCatalog *catalog)
+{
+	g_clear_pointer (&catalog->mapped, g_mapped_file_unref);
+	catalog->header = NULL;
+	catalog->lists = NULL;
+	catalog->records = NULL;
+	catalog->strings = NULL;
+}
+
+/**
+ * gpk_catalog_load:
+ * @catalog: a #GpkCatalog
+ * @error: a #GError, or %NULL
+ *
+ * Maps the file and checks that every list is inside it. The records
+ * are only checked when they are looked up.
+ *
+ * Return value: %TRUE if the file was usable
+ **/
+gboolean
+gpk_catalog_load (GpkCatalog *catalog, GError **error)
+{
+	const GpkCatalogHeader *header;
+	const GpkCatalogList *list;
+	const gchar *data;
+	gsize len;
+	guint64 expected;
+	guint i;
+	g_autoptr(GMappedFile) mapped = NULL;
+
+	g_return_val_if_fail (GPK_IS_CATALOG (catalog), FALSE);
+
+	gpk_catalog_unload (catalog);
+	mapped = g_mapped_file_new (catalog->filename, FALSE, error);
+	if (mapped == NULL)
+		return FALSE;
+
+	data = g_mapped_file_get_contents (mapped);
+	len = g_mapped_file_get_length (mapped);
+	header = (const GpkCatalogHeader *) data;
+	if (len < sizeof (GpkCatalogHeader) ||
+	    memcmp (header->magic, GPK_CATALOG_MAGIC, sizeof (header->magic)) != 0 ||
+	    header->version != GPK_CATALOG_VERSION) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+			     "%s is not a catalog of this version", catalog->filename);
+		return FALSE;
+	}
+	expected = sizeof (GpkCatalogHeader) +
+		   (guint64) header->n_lists * sizeof (GpkCatalogList) +
+		   (guint64) header->n_records * sizeof (GpkCatalogRecord) +
+		   header->strings_size;
+	if (expected != len || header->strings_size == 0 || data[len - 1] != '\0') {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+			     "%s is truncated", catalog->filename);
+		return FALSE;
+	}
+
+	catalog->lists = (const GpkCatalogList *) (data + sizeof (GpkCatalogHeader));
+	for (i = 0; i < header->n_lists; i++) {
+		list = &catalog->lists[i];
+		if (list->key >= header->strings_size ||
+		    (guint64) list->first + list->n_records > header->n_records) {
+			g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+				     "%s has an invalid list", catalog->filename);
+			catalog->lists = NULL;
+			return FALSE;
+		}
+	}
+	catalog->header = header;
+	catalog->records = (const GpkCatalogRecord *) (catalog->lists + header->n_lists);
+	catalog->strings = (const gchar *) (catalog->records + header->n_records);
+	catalog->mapped = g_steal_pointer (&mapped);
+	return TRUE;
+}
+
+static const GpkCatalogList *
+gpk_catalog_find_list (GpkCatalog *catalog, const gchar *key)
+{
+	guint i;
+
+	if (catalog->header == NULL)
+		return NULL;
+	for (i = 0; i < catalog->header->n_lists; i++) {
+		if (g_strcmp0 (catalog->strings + catalog->lists[i].key, key) == 0)
+			return &catalog->lists[i];
+	}
+	return NULL;
+}
+
+/**
+ * gpk_catalog_lookup:
+ * @catalog: a #GpkCatalog
+ * @key: the list to get
+ *
+ * Return value: (transfer container): new #PkPackage objects for the
+ * saved list, or %NULL if there is no usable list for @key
+ **/
+GPtrArray *
+gpk_catalog_lookup (GpkCatalog *catalog, const gchar *key)
+{
+	const GpkCatalogList *list;
+	const GpkCatalogRecord *record;
+	guint32 strings_size;
+	guint i;
+	g_autoptr(GPtrArray) packages = NULL;
+
+	g_return_val_if_fail (GPK_IS_CATALOG (catalog), NULL);
+	g_return_val_if_fail (key != NULL, NULL);
+
+	list = gpk_catalog_find_list (catalog, key);
+	if (list == NULL)
+		return NULL;
+
+	strings_size = catalog->header->strings_size;
+	packages = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (i = 0; i < list->n_records; i++) {
+		g_autoptr(PkPackage) package = NULL;
+
+		record = &catalog->records[list->first + i];
+		if (record->package_id >= strings_size ||
+		    record->summary >= strings_size ||
+		    record->info >= PK_INFO_ENUM_LAST) {
+			g_warning ("invalid record in %s", catalog->filename);
+			return NULL;
+		}
+		package = pk_package_new ();
+		if (!pk_package_set_id (package, catalog->strings + record->package_id, NULL))
+			continue;
+		g_object_set (package,
+			      "info", record->info,
+			      "summary", catalog->strings + record->summary,
+			      NULL);
+		g_ptr_array_add (packages, g_steal_pointer (&package));
+	}
+	return g_steal_pointer (&packages);
+}
+
+/* each string is only stored once, and the offset is returned */
+static guint32
+gpk_catalog_add_string (GByteArray *strings, GHashTable *offsets, const gchar *str)
+{
+	gpointer offset;
+	guint32 idx;
+
+	if (str == NULL)
+		str = "";
+	if (g_hash_table_lookup_extended (offsets, str, NULL, &offset))
+		return GPOINTER_TO_UINT (offset);
+	idx = strings->len;
+	g_byte_array_append (strings, (const guint8 *) str, strlen (str) + 1);
+	g_hash_table_insert (offsets, g_strdup (str), GUINT_TO_POINTER (idx));
+	return idx;
+}
+
+/* what a write needs, so it can run without the catalog */
+typedef struct {
+	gchar			*filename;
+	gchar			*key;
+	GPtrArray		*packages;
+	GMappedFile		*mapped;	/* keeps the old lists valid */
+	const GpkCatalogHeader	*header;
+	const GpkCatalogList	*lists;
+	const GpkCatalogRecord	*records;
+	const gchar		*strings;
+} GpkCatalogWriteHelper;
+
+static GpkCatalogWriteHelper *
+gpk_catalog_write_helper_new (GpkCatalog *catalog, const gchar *key, GPtrArray *packages)
+{
+	GpkCatalogWriteHelper *helper = g_new0 (GpkCatalogWriteHelper, 1);
+	guint i;
+
+	helper->filename = g_strdup (catalog->filename);
+	helper->key = g_strdup (key);
+	helper->packages = g_ptr_array_new_full (packages->len, (GDestroyNotify) g_object_unref);
+	for (i = 0; i < packages->len; i++)
+		g_ptr_array_add (helper->packages, g_object_ref (g_ptr_array_index (packages, i)));
+	if (catalog->mapped != NULL) {
+		helper->mapped = g_mapped_file_ref (catalog->mapped);
+		helper->header = catalog->header;
+		helper->lists = catalog->lists;
+		helper->records = catalog->records;
+		helper->strings = catalog->strings;
+	}
+	return helper;
+}
+
+static void
+gpk_catalog_write_helper_free (GpkCatalogWriteHelper *helper)
+{
+	if (helper->mapped != NULL)
+		g_mapped_file_unref (helper->mapped);
+	g_ptr_array_unref (helper->packages);
+	g_free (helper->key);
+	g_free (helper->filename);
+	g_free (helper);
+}
+
+/* the list is already saved with exactly these packages */
+static gboolean
+gpk_catalog_write_is_unchanged (GpkCatalogWriteHelper *helper)
+{
+	const GpkCatalogList *old = NULL;
+	const GpkCatalogRecord *record;
+	const gchar *summary;
+	PkPackage *package;
+	guint i;
+
+	for (i = 0; helper->header != NULL && i < helper->header->n_lists; i++) {
+		if (g_strcmp0 (helper->strings + helper->lists[i].key, helper->key) == 0) {
+			old = &helper->lists[i];
+			break;
+		}
+	}
+	if (old == NULL || old->n_records != helper->packages->len)
+		return FALSE;
+	for (i = 0; i < old->n_records; i++) {
+		record = &helper->records[old->first + i];
+		package = g_ptr_array_index (helper->packages, i);
+		if (record->package_id >= helper->header->strings_size ||
+		    record->summary >= helper->header->strings_size)
+			return FALSE;
+		if (record->info != (guint32) pk_package_get_info (package))
+			return FALSE;
+		if (g_strcmp0 (helper->strings + record->package_id, pk_package_get_id (package)) != 0)
+			return FALSE;
+		summary = pk_package_get_summary (package);
+		if (g_strcmp0 (helper->strings + record->summary, summary != NULL ? summary : "") != 0)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/* builds the new file from the helper alone, so it can be used in a thread */
+static gboolean
+gpk_catalog_write (GpkCatalogWriteHelper *helper, gboolean *written, GError **error)
+{
+	GpkCatalogHeader header;
+	GpkCatalogList list;
+	GpkCatalogRecord record;
+	const GpkCatalogList *old;
+	const GpkCatalogRecord *old_record;
+	PkPackage *package;
+	guint i;
+	guint j;
+	g_autofree gchar *dirname = NULL;
+	g_autoptr(GArray) lists = NULL;
+	g_autoptr(GArray) records = NULL;
+	g_autoptr(GByteArray) data = NULL;
+	g_autoptr(GByteArray) strings = NULL;
+	g_autoptr(GHashTable) offsets = NULL;
+
+	*written = FALSE;
+	if (gpk_catalog_write_is_unchanged (helper))
+		return TRUE;
+
+	lists = g_array_new (FALSE, FALSE, sizeof (GpkCatalogList));
+	records = g_array_new (FALSE, FALSE, sizeof (GpkCatalogRecord));
+	strings = g_byte_array_new ();
+	offsets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	/* the new list goes first */
+	list.key = gpk_catalog_add_string (strings, offsets, helper->key);
+	list.first = 0;
+	list.n_records = helper->packages->len;
+	g_array_append_val (lists, list);
+	for (i = 0; i < helper->packages->len; i++) {
+		package = g_ptr_array_index (helper->packages, i);
+		record.package_id = gpk_catalog_add_string (strings, offsets, pk_package_get_id (package));
+		record.summary = gpk_catalog_add_string (strings, offsets, pk_package_get_summary (package));
+		record.info = pk_package_get_info (package);
+		g_array_append_val (records, record);
+	}
+
+	/* then whatever was already saved */
+	for (i = 0; helper->header != NULL && i < helper->header->n_lists; i++) {
+		if (lists->len >= GPK_CATALOG_MAX_LISTS)
+			break;
+		old = &helper->lists[i];
+		if (g_strcmp0 (helper->strings + old->key, helper->key) == 0)
+			continue;
+		list.key = gpk_catalog_add_string (strings, offsets, helper->strings + old->key);
+		list.first = records->len;
+		list.n_records = 0;
+		for (j = 0; j < old->n_records; j++) {
+			old_record = &helper->records[old->first + j];
+			if (old_record->package_id >= helper->header->strings_size ||
+			    old_record->summary >= helper->header->strings_size)
+				continue;
+			record.package_id = gpk_catalog_add_string (strings, offsets,
+								    helper->strings + old_record->package_id);
+			record.summary = gpk_catalog_add_string (strings, offsets,
+								 helper->strings + old_record->summary);
+			record.info = old_record->info;
+			g_array_append_val (records, record);
+			list.n_records++;
+		}
+		g_array_append_val (lists, list);
+	}
+
+	memset (&header, 0, sizeof (header));
+	memcpy (header.magic, GPK_CATALOG_MAGIC, sizeof (header.magic));
+	header.version = GPK_CATALOG_VERSION;
+	header.n_lists = lists->len;
+	header.n_records = records->len;
+	header.strings_size = strings->len;
+	data = g_byte_array_sized_new (sizeof (header) +
+				       lists->len * sizeof (GpkCatalogList) +
+				       records->len * sizeof (GpkCatalogRecord) +
+				       strings->len);
+	g_byte_array_append (data, (const guint8 *) &header, sizeof (header));
+	g_byte_array_append (data, (const guint8 *) lists->data,
+			     lists->len * sizeof (GpkCatalogList));
+	g_byte_array_append (data, (const guint8 *) records->data,
+			     records->len * sizeof (GpkCatalogRecord));
+	g_byte_array_append (data, strings->data, strings->len);
+
+	/* the old mapping stays valid until it is dropped */
+	dirname = g_path_get_dirname (helper->filename);
+	if (g_mkdir_with_parents (dirname, 0700) < 0) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+			     "failed to create %s", dirname);
+		return FALSE;
+	}
+	if (!g_file_set_contents (helper->filename, (const gchar *) data->data,
+				  data->len, error))
+		return FALSE;
+	*written = TRUE;
+	return TRUE;
+}
+
+/**
+ * gpk_catalog_set:
+ * @catalog: a #GpkCatalog
+ * @key: the list to replace
+ * @packages: an array of #PkPackage
+ * @error: a #GError, or %NULL
+ *
+ * Saves the list as the newest, keeping the other lists that are
+ * already in the file, and maps the new file. Nothing is written if
+ * the list is already saved with the same packages.
+ *
+ * Return value: %TRUE if the file has the list
+ **/
+gboolean
+gpk_catalog_set (GpkCatalog *catalog,
+		 const gchar *key,
+		 GPtrArray *packages,
+		 GError **error)
+{
+	GpkCatalogWriteHelper *helper;
+	gboolean ret;
+	gboolean written;
+
+	g_return_val_if_fail (GPK_IS_CATALOG (catalog), FALSE);
+	g_return_val_if_fail (key != NULL, FALSE);
+	g_return_val_if_fail (packages != NULL, FALSE);
+
+	helper = gpk_catalog_write_helper_new (catalog, key, packages);
+	ret = gpk_catalog_write (helper, &written, error);
+	gpk_catalog_write_helper_free (helper);
+	if (!ret)
+		return FALSE;
+	if (!written)
+		return TRUE;
+	return gpk_catalog_load (catalog, error);
+}
+
+static void
+gpk_catalog_set_thread_cb (GTask *task,
+			   gpointer source_object,
+			   gpointer task_data,
+			   GCancellable *cancellable)
+{
+	GpkCatalogWriteHelper *helper = g_task_get_task_data (task);
+	gboolean written;
+	g_autoptr(GError) error = NULL;
+
+	if (!gpk_catalog_write (helper, &written, &error)) {
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+	g_task_return_boolean (task, written);
+}
+
+/**
+ * gpk_catalog_set_async:
+ *
+ * Saves the list like gpk_catalog_set(), but builds and writes the
+ * file in a thread. The catalog keeps the old mapping until
+ * gpk_catalog_set_finish() is called, and only one write should be
+ * running at a time, as each one starts from the lists already mapped.
+ **/
+void
+gpk_catalog_set_async (GpkCatalog *catalog,
+		       const gchar *key,
+		       GPtrArray *packages,
+		       GCancellable *cancellable,
+		       GAsyncReadyCallback callback,
+		       gpointer user_data)
+{
+	g_autoptr(GTask) task = NULL;
+
+	g_return_if_fail (GPK_IS_CATALOG (catalog));
+	g_return_if_fail (key != NULL);
+	g_return_if_fail (packages != NULL);
+
+	task = g_task_new (catalog, cancellable, callback, user_data);
+	g_task_set_source_tag (task, gpk_catalog_set_async);
+	g_task_set_task_data (task, gpk_catalog_write_helper_new (catalog, key, packages),
+			      (GDestroyNotify) gpk_catalog_write_helper_free);
+	g_task_run_in_thread (task, gpk_catalog_set_thread_cb);
+}
+
+/**
+ * gpk_catalog_set_finish:
+ *
+ * Maps the new file, if one was written.
+ *
+ * Return value: %TRUE if the file has the list
+ **/
+gboolean
+gpk_catalog_set_finish (GpkCatalog *catalog,
+			GAsyncResult *res,
+			GError **error)
+{
+	gboolean written;
+	g_autoptr(GError) error_local = NULL;
+
+	g_return_val_if_fail (GPK_IS_CATALOG (catalog), FALSE);
+	g_return_val_if_fail (g_task_is_valid (res, catalog), FALSE);
+
+	written = g_task_propagate_boolean (G_TASK (res), &error_local);
+	if (error_local != NULL) {
+		g_propagate_error (error, g_steal_pointer (&error_local));
+		return FALSE;
+	}
+	if (!written)
+		return TRUE;
+	return gpk_catalog_load (catalog, error);
+}
+
+static void
+gpk_catalog_finalize (GObject *object)
+{
+	GpkCatalog *catalog = GPK_CATALOG (object);
+
+	gpk_catalog_unload (catalog);
+	g_free (catalog->filename);
+
+	G_OBJECT_CLASS (gpk_catalog_parent_class)->finalize (object);
+}
+
+static void
+gpk_catalog_class_init (GpkCatalogClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (class);
+	object_class->finalize = gpk_catalog_finalize;
+}
+
+static void
+gpk_catalog_init (GpkCatalog *catalog)
+{
+}
+
+/**
+ * gpk_catalog_new:
+ * @filename: where the catalog is saved
+ *
+ * Return value: a new #GpkCatalog, which is empty until loaded
+ **/
+GpkCatalog *
+gpk_catalog_new (const gchar *filename)
+{
+	GpkCatalog *catalog;
+	catalog = g_object_new (GPK_TYPE_CATALOG, NULL);
+	catalog->filename = g_strdup (filename);
+	return catalog;
+}
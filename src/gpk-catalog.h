@@ -0,0 +1,54 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2007-2013 Richard Hughes <richard@hughsie.com>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef GPK_CATALOG_H
+#define GPK_CATALOG_H
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GPK_TYPE_CATALOG (gpk_catalog_get_type())
+G_DECLARE_FINAL_TYPE (GpkCatalog, gpk_catalog, GPK, CATALOG, GObject)
+
+GpkCatalog	*gpk_catalog_new			(const gchar		*filename);
+gboolean	 gpk_catalog_load			(GpkCatalog		*catalog,
+							 GError			**error);
+GPtrArray	*gpk_catalog_lookup			(GpkCatalog		*catalog,
+							 const gchar		*key);
+gboolean	 gpk_catalog_set			(GpkCatalog		*catalog,
+							 const gchar		*key,
+							 GPtrArray		*packages,
+							 GError			**error);
+void		 gpk_catalog_set_async			(GpkCatalog		*catalog,
+							 const gchar		*key,
+							 GPtrArray		*packages,
+							 GCancellable		*cancellable,
+							 GAsyncReadyCallback	 callback,
+							 gpointer		 user_data);
+gboolean	 gpk_catalog_set_finish			(GpkCatalog		*catalog,
+							 GAsyncResult		*res,
+							 GError			**error);
+
+G_END_DECLS
+
+#endif /* GPK_CATALOG_H */
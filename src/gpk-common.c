@@ -316,3 +316,244 @@ gpk_strv_join_locale (gchar **array)
 					array[3], array[4]);
 	return NULL;
 }
+
+/* compares one part of a version, e.g. "1.2a" or "3.fc35", like rpmvercmp */
+static gint
+gpk_vercmp_part (const gchar *a, const gchar *b)
+{
+	const gchar *start_a;
+	const gchar *start_b;
+	gboolean isnum;
+	gsize len_a;
+	gsize len_b;
+	gint rc;
+
+	while (*a != '\0' || *b != '\0') {
+		/* the separators don't matter */
+		while (*a != '\0' && *a != '~' && *a != '^' && !g_ascii_isalnum (*a))
+			a++;
+		while (*b != '\0' && *b != '~' && *b != '^' && !g_ascii_isalnum (*b))
+			b++;
+
+		/* a tilde sorts before anything, even the end */
+		if (*a == '~' || *b == '~') {
+			if (*a != '~')
+				return 1;
+			if (*b != '~')
+				return -1;
+			a++;
+			b++;
+			continue;
+		}
+
+		/* a caret sorts after the end, but before anything else */
+		if (*a == '^' || *b == '^') {
+			if (*a == '\0')
+				return -1;
+			if (*b == '\0')
+				return 1;
+			if (*a != '^')
+				return 1;
+			if (*b != '^')
+				return -1;
+			a++;
+			b++;
+			continue;
+		}
+		if (*a == '\0' || *b == '\0')
+			break;
+
+		/* take a run of digits or a run of letters from each */
+		start_a = a;
+		start_b = b;
+		isnum = g_ascii_isdigit (*a);
+		if (isnum) {
+			while (g_ascii_isdigit (*a))
+				a++;
+			while (g_ascii_isdigit (*b))
+				b++;
+		} else {
+			while (g_ascii_isalpha (*a))
+				a++;
+			while (g_ascii_isalpha (*b))
+				b++;
+		}
+
+		/* a number is always newer than letters */
+		if (b == start_b)
+			return isnum ? 1 : -1;
+
+		if (isnum) {
+			while (*start_a == '0' && start_a + 1 < a)
+				start_a++;
+			while (*start_b == '0' && start_b + 1 < b)
+				start_b++;
+		}
+		len_a = a - start_a;
+		len_b = b - start_b;
+		if (isnum && len_a != len_b)
+			return len_a > len_b ? 1 : -1;
+		rc = strncmp (start_a, start_b, MIN (len_a, len_b));
+		if (rc != 0)
+			return rc > 0 ? 1 : -1;
+		if (len_a != len_b)
+			return len_a > len_b ? 1 : -1;
+	}
+
+	/* whichever has something left over is newer */
+	if (*a == '\0' && *b == '\0')
+		return 0;
+	return *a == '\0' ? -1 : 1;
+}
+
+/**
+ * gpk_vercmp:
+ * @a: a version, e.g. "1:2.3-4.fc35"
+ * @b: another version
+ *
+ * Compares two package versions using the epoch, version and release,
+ * in the same way as rpm does, including the tilde and caret. This is
+ * only used when the backend cannot pick the newest packages itself, and
+ * does not follow the dpkg rules for punctuation.
+ *
+ * Return value: a negative value if @a is older, zero if they are the
+ * same, and a positive value if @a is newer
+ **/
+gint
+gpk_vercmp (const gchar *a, const gchar *b)
+{
+	const gchar *colon;
+	guint64 epoch_a = 0;
+	guint64 epoch_b = 0;
+	gint rc;
+	g_autofree gchar *version_a = NULL;
+	g_autofree gchar *version_b = NULL;
+	gchar *release_a;
+	gchar *release_b;
+
+	if (a == NULL || b == NULL)
+		return g_strcmp0 (a, b);
+
+	/* a missing epoch is zero */
+	colon = strchr (a, ':');
+	if (colon != NULL) {
+		epoch_a = g_ascii_strtoull (a, NULL, 10);
+		a = colon + 1;
+	}
+	colon = strchr (b, ':');
+	if (colon != NULL) {
+		epoch_b = g_ascii_strtoull (b, NULL, 10);
+		b = colon + 1;
+	}
+	if (epoch_a != epoch_b)
+		return epoch_a > epoch_b ? 1 : -1;
+
+	/* the release is only used if the versions are the same */
+	version_a = g_strdup (a);
+	version_b = g_strdup (b);
+	release_a = strrchr (version_a, '-');
+	if (release_a != NULL)
+		*release_a++ = '\0';
+	release_b = strrchr (version_b, '-');
+	if (release_b != NULL)
+		*release_b++ = '\0';
+	rc = gpk_vercmp_part (version_a, version_b);
+	if (rc != 0)
+		return rc;
+	return gpk_vercmp_part (release_a != NULL ? release_a : "",
+				release_b != NULL ? release_b : "");
+}
+
+/* the same architecture can have a different name in each distro */
+static const gchar *
+gpk_arch_normalize (const gchar *arch)
+{
+	if (g_strcmp0 (arch, "amd64") == 0)
+		return "x86_64";
+	if (g_strcmp0 (arch, "arm64") == 0)
+		return "aarch64";
+	if (g_strcmp0 (arch, "ppc64el") == 0)
+		return "ppc64le";
+	if (g_strcmp0 (arch, "armhf") == 0 ||
+	    g_strcmp0 (arch, "armv7hl") == 0)
+		return "armv7l";
+	if (g_strcmp0 (arch, "i386") == 0 ||
+	    g_strcmp0 (arch, "i486") == 0 ||
+	    g_strcmp0 (arch, "i586") == 0 ||
+	    g_strcmp0 (arch, "x86") == 0)
+		return "i686";
+	return arch;
+}
+
+/* set from the backend, or NULL to use the architecture we were built for */
+static gchar *gpk_arch_native = NULL;
+
+/* the userland this was built for, which is what the package manager
+ * installs for, even if the kernel is 64 bit */
+static const gchar *
+gpk_arch_get_build (void)
+{
+#if defined(__x86_64__) && defined(__ILP32__)
+	return "x32";
+#elif defined(__x86_64__)
+	return "x86_64";
+#elif defined(__i386__)
+	return "i686";
+#elif defined(__aarch64__)
+	return "aarch64";
+#elif defined(__arm__)
+	return "armv7l";
+#elif defined(__powerpc64__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	return "ppc64le";
+#elif defined(__powerpc64__)
+	return "ppc64";
+#elif defined(__s390x__)
+	return "s390x";
+#elif defined(__riscv) && __riscv_xlen == 64
+	return "riscv64";
+#else
+	return NULL;
+#endif
+}
+
+/**
+ * gpk_arch_set_native:
+ * @arch: the architecture the backend installs for, or %NULL
+ *
+ * Sets the architecture used by gpk_arch_is_native(), e.g. from the
+ * distro-id of the daemon. Until this is called the architecture this
+ * program was built for is used.
+ **/
+void
+gpk_arch_set_native (const gchar *arch)
+{
+	g_clear_pointer (&gpk_arch_native, g_free);
+	if (arch != NULL && arch[0] != '\0')
+		gpk_arch_native = g_strdup (gpk_arch_normalize (arch));
+}
+
+/**
+ * gpk_arch_is_native:
+ * @arch: a package architecture, e.g. "x86_64" or "noarch"
+ *
+ * Return value: %TRUE if packages of this architecture are built for
+ * the userland, or do not depend on the architecture at all. If the
+ * native architecture is not known every package is native.
+ **/
+gboolean
+gpk_arch_is_native (const gchar *arch)
+{
+	const gchar *native;
+
+	if (arch == NULL || arch[0] == '\0')
+		return TRUE;
+	if (g_strcmp0 (arch, "noarch") == 0 ||
+	    g_strcmp0 (arch, "all") == 0 ||
+	    g_strcmp0 (arch, "any") == 0)
+		return TRUE;
+
+	native = gpk_arch_native != NULL ? gpk_arch_native : gpk_arch_get_build ();
+	if (native == NULL)
+		return TRUE;
+	return g_strcmp0 (gpk_arch_normalize (arch), native) == 0;
+}
@@ -46,6 +46,7 @@ G_BEGIN_DECLS
 #define GPK_SETTINGS_ONLY_NEWEST			"only-newest"
 #define GPK_SETTINGS_REPO_SHOW_DETAILS			"repo-show-details"
 #define GPK_SETTINGS_SCROLL_ACTIVE			"scroll-active"
+#define GPK_SETTINGS_SEARCH_DELAY			"search-delay"
 #define GPK_SETTINGS_SEARCH_MODE			"search-mode"
 #define GPK_SETTINGS_SHOW_ALL_PACKAGES			"show-all-packages"
 #define GPK_SETTINGS_SHOW_DEPENDS			"show-depends"
@@ -74,6 +75,10 @@ gboolean	 gpk_window_set_parent_xid		(GtkWindow	*window,
 							 guint32	 xid);
 GPtrArray	*pk_strv_to_ptr_array			(gchar		**array)
 							 G_GNUC_WARN_UNUSED_RESULT;
+gint		 gpk_vercmp				(const gchar	*a,
+							 const gchar	*b);
+void		 gpk_arch_set_native			(const gchar	*arch);
+gboolean	 gpk_arch_is_native			(const gchar	*arch);
 
 G_END_DECLS
 
@@ -29,6 +29,7 @@
 #include "gpk-common.h"
 #include "gpk-dialog.h"
 #include "gpk-enum.h"
+#include "gpk-file-model.h"
 
 enum {
 	GPK_DIALOG_STORE_IMAGE,
@@ -190,49 +191,115 @@ gpk_dialog_embed_package_list_widget (GtkDialog *dialog, GPtrArray *array)
 	return TRUE;
 }
 
+static void
+gpk_dialog_file_list_search_changed_cb (GtkSearchEntry *entry, GtkTreeView *treeview)
+{
+	GpkFileModel *model;
+
+	/* swapping the model out is much quicker than a signal per row */
+	model = g_object_get_data (G_OBJECT (treeview), "GpkDialog::model");
+	gtk_tree_view_set_model (treeview, NULL);
+	gpk_file_model_set_filter (model, gtk_entry_get_text (GTK_ENTRY (entry)));
+	gtk_tree_view_set_model (treeview, GTK_TREE_MODEL (model));
+}
+
+static void
+gpk_dialog_file_list_sort_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	GpkFileModel *model = GPK_FILE_MODEL (source);
+	GtkTreeView *treeview;
+	g_autoptr(GError) error = NULL;
+
+	/* the treeview has been destroyed if this was cancelled */
+	if (!gpk_file_model_sort_finish (model, res, &error)) {
+		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			g_warning ("failed to sort files: %s", error->message);
+		return;
+	}
+
+	/* the rows were reordered without any signals */
+	treeview = GTK_TREE_VIEW (user_data);
+	gtk_tree_view_set_model (treeview, NULL);
+	gtk_tree_view_set_model (treeview, GTK_TREE_MODEL (model));
+}
+
+static void
+gpk_dialog_file_list_destroy_cb (GtkWidget *widget, GCancellable *cancellable)
+{
+	g_cancellable_cancel (cancellable);
+}
+
+/* takes ownership of files */
 gboolean
-gpk_dialog_embed_file_list_widget (GtkDialog *dialog, GPtrArray *files)
+gpk_dialog_embed_file_list_widget (GtkDialog *dialog, gchar **files)
 {
 	GtkWidget *scroll;
 	GtkWidget *widget;
-	GtkTextBuffer *buffer;
-	g_auto(GStrv) array = NULL;
-	g_autofree gchar *text = NULL;
-
-	/* split and show */
-	array = pk_ptr_array_to_strv (files);
-	text = g_strjoinv ("\n", array);
-	if (text[0] == '\0') {
-		g_free (text);
-		text = g_strdup (_("No files"));
+	GtkWidget *treeview;
+	GtkWidget *entry;
+	GtkWidget *box;
+	GtkCellRenderer *renderer;
+	GtkTreeViewColumn *column;
+	GCancellable *cancellable;
+	GpkFileModel *model;
+
+	/* nothing to list */
+	if (files == NULL || files[0] == NULL) {
+		g_strfreev (files);
+		widget = gtk_label_new (_("No files"));
+		gtk_widget_show (widget);
+		box = gtk_dialog_get_content_area (GTK_DIALOG(dialog));
+		gtk_box_pack_start (GTK_BOX (box), widget, TRUE, TRUE, 0);
+		return TRUE;
 	}
 
-	/* create a text view to hold the store */
-	widget = gtk_text_view_new ();
-	gtk_text_view_set_editable (GTK_TEXT_VIEW (widget), FALSE);
-	gtk_text_view_set_left_margin (GTK_TEXT_VIEW (widget), 5);
-	gtk_text_view_set_right_margin (GTK_TEXT_VIEW (widget), 5);
+	/* only the rows on screen are ever measured or drawn */
+	model = gpk_file_model_new (files);
+	treeview = gtk_tree_view_new_with_model (GTK_TREE_MODEL (model));
+	renderer = gtk_cell_renderer_text_new ();
+	column = gtk_tree_view_column_new_with_attributes (_("File"), renderer,
+							   "text", GPK_FILE_MODEL_COLUMN_FILENAME, NULL);
+	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
+	gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (treeview), TRUE);
+	gtk_tree_view_set_headers_visible (GTK_TREE_VIEW (treeview), FALSE);
+	gtk_tree_view_set_enable_search (GTK_TREE_VIEW (treeview), FALSE);
+	g_object_set_data_full (G_OBJECT (treeview), "GpkDialog::model",
+				model, g_object_unref);
+	gtk_widget_show (treeview);
 
 	/* scroll the treeview */
 	scroll = gtk_scrolled_window_new (NULL, NULL);
 	gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scroll),
-					GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
-	gtk_container_add (GTK_CONTAINER (scroll), widget);
+					GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+	gtk_container_add (GTK_CONTAINER (scroll), treeview);
+	gtk_widget_set_size_request (GTK_WIDGET (scroll), -1, 300);
 	gtk_widget_show (scroll);
 
-	/* set in buffer */
-	buffer = gtk_text_buffer_new (NULL);
-	gtk_text_buffer_set_text (buffer, text, -1);
-	gtk_text_view_set_buffer (GTK_TEXT_VIEW (widget), buffer);
-	gtk_widget_show (widget);
+	/* filter as the user types */
+	entry = gtk_search_entry_new ();
+	g_signal_connect (entry, "search-changed",
+			  G_CALLBACK (gpk_dialog_file_list_search_changed_cb), treeview);
+	gtk_widget_show (entry);
 
 	/* add some spacing to conform to the GNOME HIG */
-	gtk_container_set_border_width (GTK_CONTAINER (scroll), 6);
-	gtk_widget_set_size_request (GTK_WIDGET (scroll), -1, 300);
+	box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 6);
+	gtk_container_set_border_width (GTK_CONTAINER (box), 6);
+	gtk_box_pack_start (GTK_BOX (box), entry, FALSE, FALSE, 0);
+	gtk_box_pack_start (GTK_BOX (box), scroll, TRUE, TRUE, 0);
+	gtk_widget_show (box);
 
-	/* add scrolled window */
+	/* add box */
 	widget = gtk_dialog_get_content_area (GTK_DIALOG(dialog));
-	gtk_box_pack_start (GTK_BOX (widget), scroll, TRUE, TRUE, 0);
+	gtk_box_pack_start (GTK_BOX (widget), box, TRUE, TRUE, 0);
+
+	/* show them as they come, and in order when the thread is done */
+	cancellable = g_cancellable_new ();
+	g_signal_connect_data (treeview, "destroy",
+			       G_CALLBACK (gpk_dialog_file_list_destroy_cb),
+			       cancellable, (GClosureNotify) g_object_unref, 0);
+	gpk_file_model_sort_async (model, cancellable,
+				   gpk_dialog_file_list_sort_cb, treeview);
 
 	return TRUE;
 }
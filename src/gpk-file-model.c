@@ -0,0 +1,413 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2007-2013 Richard Hughes <richard@hughsie.com>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "gpk-file-model.h"
+
+/*
+ * A flat list model over the NULL terminated array of filenames that
+ * PackageKit returns, so a package with tens of thousands of files costs
+ * no more than the strings themselves and only the rows on screen are
+ * ever rendered.
+ *
+ * The filter is a list of row numbers into the files array, and is only
+ * kept when there is something to filter on.
+ *
+ * Filtering and sorting replace every row without emitting a signal for
+ * each one, so views should be detached from the model while they run.
+ */
+struct _GpkFileModel
+{
+	GObject			 parent_instance;
+	gchar			**files;
+	guint			 files_len;
+	GArray			*matches;	/* of guint, or NULL for all */
+	gchar			*filter;
+	gint			 stamp;
+};
+
+static void gpk_file_model_tree_model_init (GtkTreeModelIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (GpkFileModel, gpk_file_model, G_TYPE_OBJECT,
+			 G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+						gpk_file_model_tree_model_init))
+
+static guint
+gpk_file_model_get_n_rows (GpkFileModel *model)
+{
+	if (model->matches != NULL)
+		return model->matches->len;
+	return model->files_len;
+}
+
+static const gchar *
+gpk_file_model_get_filename (GpkFileModel *model, guint idx)
+{
+	if (model->matches != NULL)
+		idx = g_array_index (model->matches, guint, idx);
+	return model->files[idx];
+}
+
+static gboolean
+gpk_file_model_iter_set (GpkFileModel *model, GtkTreeIter *iter, guint idx)
+{
+	if (idx >= gpk_file_model_get_n_rows (model)) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	iter->stamp = model->stamp;
+	iter->user_data = GUINT_TO_POINTER (idx);
+	return TRUE;
+}
+
+static guint
+gpk_file_model_iter_get (GpkFileModel *model, GtkTreeIter *iter)
+{
+	g_return_val_if_fail (iter->stamp == model->stamp, G_MAXUINT);
+	return GPOINTER_TO_UINT (iter->user_data);
+}
+
+static GtkTreeModelFlags
+gpk_file_model_get_flags (GtkTreeModel *tree_model)
+{
+	return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+gpk_file_model_get_n_columns (GtkTreeModel *tree_model)
+{
+	return GPK_FILE_MODEL_COLUMN_LAST;
+}
+
+static GType
+gpk_file_model_get_column_type (GtkTreeModel *tree_model, gint idx)
+{
+	if (idx == GPK_FILE_MODEL_COLUMN_FILENAME)
+		return G_TYPE_STRING;
+	return G_TYPE_INVALID;
+}
+
+static gboolean
+gpk_file_model_get_iter (GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreePath *path)
+{
+	GpkFileModel *model = GPK_FILE_MODEL (tree_model);
+	if (gtk_tree_path_get_depth (path) != 1)
+		return FALSE;
+	return gpk_file_model_iter_set (model, iter, gtk_tree_path_get_indices (path)[0]);
+}
+
+static GtkTreePath *
+gpk_file_model_get_path (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	GpkFileModel *model = GPK_FILE_MODEL (tree_model);
+	return gtk_tree_path_new_from_indices (gpk_file_model_iter_get (model, iter), -1);
+}
+
+static void
+gpk_file_model_get_value (GtkTreeModel *tree_model, GtkTreeIter *iter,
+			  gint column, GValue *value)
+{
+	GpkFileModel *model = GPK_FILE_MODEL (tree_model);
+	guint idx;
+
+	g_value_init (value, gpk_file_model_get_column_type (tree_model, column));
+	idx = gpk_file_model_iter_get (model, iter);
+	if (column == GPK_FILE_MODEL_COLUMN_FILENAME)
+		g_value_set_string (value, gpk_file_model_get_filename (model, idx));
+}
+
+static gboolean
+gpk_file_model_iter_next (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	GpkFileModel *model = GPK_FILE_MODEL (tree_model);
+	return gpk_file_model_iter_set (model, iter, gpk_file_model_iter_get (model, iter) + 1);
+}
+
+static gboolean
+gpk_file_model_iter_previous (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	GpkFileModel *model = GPK_FILE_MODEL (tree_model);
+	guint idx = gpk_file_model_iter_get (model, iter);
+	if (idx == 0) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	return gpk_file_model_iter_set (model, iter, idx - 1);
+}
+
+static gboolean
+gpk_file_model_iter_children (GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *parent)
+{
+	GpkFileModel *model = GPK_FILE_MODEL (tree_model);
+	if (parent != NULL) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	return gpk_file_model_iter_set (model, iter, 0);
+}
+
+static gboolean
+gpk_file_model_iter_has_child (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	return FALSE;
+}
+
+static gint
+gpk_file_model_iter_n_children (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	GpkFileModel *model = GPK_FILE_MODEL (tree_model);
+	if (iter != NULL)
+		return 0;
+	return gpk_file_model_get_n_rows (model);
+}
+
+static gboolean
+gpk_file_model_iter_nth_child (GtkTreeModel *tree_model, GtkTreeIter *iter,
+			       GtkTreeIter *parent, gint n)
+{
+	GpkFileModel *model = GPK_FILE_MODEL (tree_model);
+	if (parent != NULL || n < 0) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	return gpk_file_model_iter_set (model, iter, n);
+}
+
+static gboolean
+gpk_file_model_iter_parent (GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *child)
+{
+	iter->stamp = 0;
+	return FALSE;
+}
+
+static void
+gpk_file_model_tree_model_init (GtkTreeModelIface *iface)
+{
+	iface->get_flags = gpk_file_model_get_flags;
+	iface->get_n_columns = gpk_file_model_get_n_columns;
+	iface->get_column_type = gpk_file_model_get_column_type;
+	iface->get_iter = gpk_file_model_get_iter;
+	iface->get_path = gpk_file_model_get_path;
+	iface->get_value = gpk_file_model_get_value;
+	iface->iter_next = gpk_file_model_iter_next;
+	iface->iter_previous = gpk_file_model_iter_previous;
+	iface->iter_children = gpk_file_model_iter_children;
+	iface->iter_has_child = gpk_file_model_iter_has_child;
+	iface->iter_n_children = gpk_file_model_iter_n_children;
+	iface->iter_nth_child = gpk_file_model_iter_nth_child;
+	iface->iter_parent = gpk_file_model_iter_parent;
+}
+
+/* only the filter that is set, from scratch */
+static void
+gpk_file_model_refilter (GpkFileModel *model)
+{
+	guint i;
+
+	g_clear_pointer (&model->matches, g_array_unref);
+	if (model->filter == NULL)
+		return;
+	model->matches = g_array_new (FALSE, FALSE, sizeof (guint));
+	for (i = 0; i < model->files_len; i++) {
+		if (strstr (model->files[i], model->filter) != NULL)
+			g_array_append_val (model->matches, i);
+	}
+}
+
+/**
+ * gpk_file_model_get_size:
+ *
+ * Return value: the number of rows that match the filter
+ **/
+guint
+gpk_file_model_get_size (GpkFileModel *model)
+{
+	g_return_val_if_fail (GPK_IS_FILE_MODEL (model), 0);
+	return gpk_file_model_get_n_rows (model);
+}
+
+/**
+ * gpk_file_model_set_filter:
+ *
+ * Only shows the files that contain text, or all of them if text is
+ * %NULL or empty. When text extends the current filter only the rows
+ * that are already shown are searched again.
+ **/
+void
+gpk_file_model_set_filter (GpkFileModel *model, const gchar *text)
+{
+	g_autoptr(GArray) matches = NULL;
+	guint i;
+	guint idx;
+
+	g_return_if_fail (GPK_IS_FILE_MODEL (model));
+
+	if (text != NULL && text[0] == '\0')
+		text = NULL;
+	if (g_strcmp0 (text, model->filter) == 0)
+		return;
+	model->stamp++;
+
+	/* narrowing the search, so no need to look at everything */
+	if (text != NULL && model->filter != NULL &&
+	    model->matches != NULL && strstr (text, model->filter) != NULL) {
+		matches = g_array_sized_new (FALSE, FALSE, sizeof (guint), model->matches->len);
+		for (i = 0; i < model->matches->len; i++) {
+			idx = g_array_index (model->matches, guint, i);
+			if (strstr (model->files[idx], text) != NULL)
+				g_array_append_val (matches, idx);
+		}
+		g_free (model->filter);
+		model->filter = g_strdup (text);
+		g_array_unref (model->matches);
+		model->matches = g_steal_pointer (&matches);
+		return;
+	}
+
+	g_free (model->filter);
+	model->filter = g_strdup (text);
+	gpk_file_model_refilter (model);
+}
+
+static gint
+gpk_file_model_sort_cb (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	return g_strcmp0 (*((const gchar **) a), *((const gchar **) b));
+}
+
+static void
+gpk_file_model_sort_thread_cb (GTask *task,
+			       gpointer source_object,
+			       gpointer task_data,
+			       GCancellable *cancellable)
+{
+	gchar **files = g_task_get_task_data (task);
+
+	g_qsort_with_data (files, g_strv_length (files), sizeof (gchar *),
+			   gpk_file_model_sort_cb, NULL);
+	if (g_task_return_error_if_cancelled (task)) {
+		g_free (files);
+		return;
+	}
+	g_task_return_pointer (task, files, g_free);
+}
+
+/**
+ * gpk_file_model_sort_async:
+ *
+ * Sorts the files in a thread, so that huge lists do not block the UI.
+ * The model keeps its old order until gpk_file_model_sort_finish() is
+ * called.
+ **/
+void
+gpk_file_model_sort_async (GpkFileModel *model,
+			   GCancellable *cancellable,
+			   GAsyncReadyCallback callback,
+			   gpointer user_data)
+{
+	g_autoptr(GTask) task = NULL;
+	gchar **files;
+
+	g_return_if_fail (GPK_IS_FILE_MODEL (model));
+
+	/* the strings are shared, only the order belongs to the thread */
+	files = g_new0 (gchar *, model->files_len + 1);
+	memcpy (files, model->files, model->files_len * sizeof (gchar *));
+
+	task = g_task_new (model, cancellable, callback, user_data);
+	g_task_set_source_tag (task, gpk_file_model_sort_async);
+	g_task_set_task_data (task, files, NULL);
+	g_task_run_in_thread (task, gpk_file_model_sort_thread_cb);
+}
+
+/**
+ * gpk_file_model_sort_finish:
+ *
+ * Puts the rows in the sorted order, and applies the filter again.
+ **/
+gboolean
+gpk_file_model_sort_finish (GpkFileModel *model,
+			    GAsyncResult *res,
+			    GError **error)
+{
+	gchar **files;
+
+	g_return_val_if_fail (GPK_IS_FILE_MODEL (model), FALSE);
+	g_return_val_if_fail (g_task_is_valid (res, model), FALSE);
+
+	files = g_task_propagate_pointer (G_TASK (res), error);
+	if (files == NULL)
+		return FALSE;
+
+	/* the strings now belong to the new array */
+	g_free (model->files);
+	model->files = files;
+	model->stamp++;
+	gpk_file_model_refilter (model);
+	return TRUE;
+}
+
+static void
+gpk_file_model_finalize (GObject *object)
+{
+	GpkFileModel *model = GPK_FILE_MODEL (object);
+
+	g_strfreev (model->files);
+	if (model->matches != NULL)
+		g_array_unref (model->matches);
+	g_free (model->filter);
+
+	G_OBJECT_CLASS (gpk_file_model_parent_class)->finalize (object);
+}
+
+static void
+gpk_file_model_class_init (GpkFileModelClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (class);
+	object_class->finalize = gpk_file_model_finalize;
+}
+
+static void
+gpk_file_model_init (GpkFileModel *model)
+{
+	model->stamp = g_random_int ();
+}
+
+/**
+ * gpk_file_model_new:
+ * @files: a %NULL terminated array of filenames, which is taken
+ *
+ * Return value: a new #GpkFileModel in the order given
+ **/
+GpkFileModel *
+gpk_file_model_new (gchar **files)
+{
+	GpkFileModel *model;
+	model = g_object_new (GPK_TYPE_FILE_MODEL, NULL);
+	model->files = files != NULL ? files : g_new0 (gchar *, 1);
+	model->files_len = g_strv_length (model->files);
+	return model;
+}
@@ -0,0 +1,53 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2007-2013 Richard Hughes <richard@hughsie.com>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef GPK_FILE_MODEL_H
+#define GPK_FILE_MODEL_H
+
+#include <glib-object.h>
+#include <gio/gio.h>
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+#define GPK_TYPE_FILE_MODEL (gpk_file_model_get_type())
+G_DECLARE_FINAL_TYPE (GpkFileModel, gpk_file_model, GPK, FILE_MODEL, GObject)
+
+typedef enum {
+	GPK_FILE_MODEL_COLUMN_FILENAME,
+	GPK_FILE_MODEL_COLUMN_LAST
+} GpkFileModelColumn;
+
+GpkFileModel	*gpk_file_model_new			(gchar			**files);
+guint		 gpk_file_model_get_size		(GpkFileModel		*model);
+void		 gpk_file_model_set_filter		(GpkFileModel		*model,
+							 const gchar		*text);
+void		 gpk_file_model_sort_async		(GpkFileModel		*model,
+							 GCancellable		*cancellable,
+							 GAsyncReadyCallback	 callback,
+							 gpointer		 user_data);
+gboolean	 gpk_file_model_sort_finish		(GpkFileModel		*model,
+							 GAsyncResult		*res,
+							 GError			**error);
+
+G_END_DECLS
+
+#endif /* GPK_FILE_MODEL_H */
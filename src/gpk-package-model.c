@@ -0,0 +1,1332 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2007-2013 Richard Hughes <richard@hughsie.com>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <packagekit-glib2/packagekit.h>
+
+#include "gpk-common.h"
+#include "gpk-package-model.h"
+
+/*
+ * A flat list model that keeps a reference to each PkPackage and one
+ * PkBitfield of state per row. The strings are never copied, and the
+ * columns that are only needed for drawing are worked out by the
+ * GpkPackageModelFunc when the view asks for them.
+ *
+ * An optional message row (used for the welcome and "no results" text)
+ * is always shown after the packages.
+ *
+ * The name and package-id indexes are kept up to date while rows are
+ * appended, and are rebuilt the next time they are needed if rows are
+ * inserted or reordered.
+ *
+ * Each package can be given a rank. The default sort shows the rows
+ * with a lower rank first, and sorting by a column ignores the rank.
+ *
+ * New rows are always appended, and are only moved into place when
+ * gpk_package_model_sort_added() is called, so a batch of rows costs
+ * one sort of the new rows, one merge and one rows-reordered signal.
+ *
+ * The installed, arch and newest filters can be applied here rather
+ * than by the backend. Packages that do not match are kept but not
+ * shown, so changing the filters never needs another transaction.
+ * The row numbers the view sees are then looked up in the visible
+ * array, which is kept in package order.
+ *
+ * When the shown rows change, the new visible array is built from the
+ * start while the rest of the old one is still used for the rows after
+ * it, so only the rows that appear or disappear are signalled and the
+ * model is consistent for the view at every signal.
+ */
+struct _GpkPackageModel
+{
+	GObject			 parent_instance;
+	GPtrArray		*packages;
+	GArray			*states;
+	GArray			*ranks;		/* guint per package, lowest first */
+	guint			 n_sorted;	/* packages known to be in order */
+	GHashTable		*names;		/* name to row index + 1 */
+	GHashTable		*ids;		/* package-id to row index + 1 */
+	gboolean		 index_valid;
+	PkBitfield		 filters;
+	GArray			*visible;	/* row to package index, or NULL for all */
+	GArray			*visible_old;	/* rows after the visible array while it is rebuilt */
+	guint			 visible_old_pos;
+	GHashTable		*newest;	/* "name;arch" to the newest available PkPackage */
+	gchar			*message;
+	gchar			*message_icon;
+	gint			 stamp;
+	gint			 sort_column_id;
+	GtkSortType		 sort_order;
+	GpkPackageModelFunc	 func;
+	gpointer		 func_data;
+};
+
+static void gpk_package_model_tree_model_init (GtkTreeModelIface *iface);
+static void gpk_package_model_tree_sortable_init (GtkTreeSortableIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (GpkPackageModel, gpk_package_model, G_TYPE_OBJECT,
+			 G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+						gpk_package_model_tree_model_init)
+			 G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_SORTABLE,
+						gpk_package_model_tree_sortable_init))
+
+static guint
+gpk_package_model_get_n_shown (GpkPackageModel *model)
+{
+	if (model->visible_old != NULL)
+		return model->visible->len + model->visible_old->len - model->visible_old_pos;
+	if (model->visible != NULL)
+		return model->visible->len;
+	return model->packages->len;
+}
+
+static guint
+gpk_package_model_get_n_rows (GpkPackageModel *model)
+{
+	return gpk_package_model_get_n_shown (model) + (model->message != NULL ? 1 : 0);
+}
+
+static guint
+gpk_package_model_row_to_index (GpkPackageModel *model, guint row)
+{
+	if (model->visible == NULL)
+		return row;
+	if (row >= model->visible->len && model->visible_old != NULL) {
+		return g_array_index (model->visible_old, guint,
+				      row - model->visible->len + model->visible_old_pos);
+	}
+	return g_array_index (model->visible, guint, row);
+}
+
+/* the first row showing a package at or after @idx */
+static guint
+gpk_package_model_index_to_row (GpkPackageModel *model, guint idx)
+{
+	guint low = 0;
+	guint high;
+	guint mid;
+
+	if (model->visible == NULL)
+		return idx;
+	high = model->visible->len;
+	while (low < high) {
+		mid = (low + high) / 2;
+		if (g_array_index (model->visible, guint, mid) < idx)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+static gboolean
+gpk_package_model_index_is_shown (GpkPackageModel *model, guint idx, guint *row)
+{
+	guint tmp = gpk_package_model_index_to_row (model, idx);
+	if (tmp >= gpk_package_model_get_n_shown (model))
+		return FALSE;
+	if (gpk_package_model_row_to_index (model, tmp) != idx)
+		return FALSE;
+	*row = tmp;
+	return TRUE;
+}
+
+static gboolean
+gpk_package_model_iter_set (GpkPackageModel *model, GtkTreeIter *iter, guint idx)
+{
+	if (idx >= gpk_package_model_get_n_rows (model)) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	iter->stamp = model->stamp;
+	iter->user_data = GUINT_TO_POINTER (idx);
+	return TRUE;
+}
+
+static guint
+gpk_package_model_iter_get (GpkPackageModel *model, GtkTreeIter *iter)
+{
+	g_return_val_if_fail (iter->stamp == model->stamp, G_MAXUINT);
+	return GPOINTER_TO_UINT (iter->user_data);
+}
+
+static GtkTreeModelFlags
+gpk_package_model_get_flags (GtkTreeModel *tree_model)
+{
+	return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+gpk_package_model_get_n_columns (GtkTreeModel *tree_model)
+{
+	return GPK_PACKAGE_MODEL_COLUMN_LAST;
+}
+
+static GType
+gpk_package_model_get_column_type (GtkTreeModel *tree_model, gint idx)
+{
+	switch (idx) {
+	case GPK_PACKAGE_MODEL_COLUMN_STATE:
+		return G_TYPE_UINT64;
+	case GPK_PACKAGE_MODEL_COLUMN_CHECKBOX:
+	case GPK_PACKAGE_MODEL_COLUMN_CHECKBOX_VISIBLE:
+		return G_TYPE_BOOLEAN;
+	case GPK_PACKAGE_MODEL_COLUMN_IMAGE:
+	case GPK_PACKAGE_MODEL_COLUMN_TEXT:
+	case GPK_PACKAGE_MODEL_COLUMN_ID:
+	case GPK_PACKAGE_MODEL_COLUMN_SUMMARY:
+		return G_TYPE_STRING;
+	default:
+		break;
+	}
+	return G_TYPE_INVALID;
+}
+
+static gboolean
+gpk_package_model_get_iter (GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreePath *path)
+{
+	GpkPackageModel *model = GPK_PACKAGE_MODEL (tree_model);
+	if (gtk_tree_path_get_depth (path) != 1)
+		return FALSE;
+	return gpk_package_model_iter_set (model, iter, gtk_tree_path_get_indices (path)[0]);
+}
+
+static GtkTreePath *
+gpk_package_model_get_path (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	GpkPackageModel *model = GPK_PACKAGE_MODEL (tree_model);
+	return gtk_tree_path_new_from_indices (gpk_package_model_iter_get (model, iter), -1);
+}
+
+static void
+gpk_package_model_get_value (GtkTreeModel *tree_model, GtkTreeIter *iter,
+			     gint column, GValue *value)
+{
+	GpkPackageModel *model = GPK_PACKAGE_MODEL (tree_model);
+	PkPackage *package;
+	PkBitfield state;
+	guint idx;
+
+	g_value_init (value, gpk_package_model_get_column_type (tree_model, column));
+	idx = gpk_package_model_iter_get (model, iter);
+
+	/* the message row only has an icon and some text */
+	if (idx >= gpk_package_model_get_n_shown (model)) {
+		if (column == GPK_PACKAGE_MODEL_COLUMN_TEXT)
+			g_value_set_string (value, model->message);
+		else if (column == GPK_PACKAGE_MODEL_COLUMN_IMAGE)
+			g_value_set_string (value, model->message_icon);
+		return;
+	}
+
+	idx = gpk_package_model_row_to_index (model, idx);
+	package = g_ptr_array_index (model->packages, idx);
+	state = g_array_index (model->states, PkBitfield, idx);
+	switch (column) {
+	case GPK_PACKAGE_MODEL_COLUMN_STATE:
+		g_value_set_uint64 (value, state);
+		break;
+	case GPK_PACKAGE_MODEL_COLUMN_ID:
+		g_value_set_string (value, pk_package_get_id (package));
+		break;
+	case GPK_PACKAGE_MODEL_COLUMN_SUMMARY:
+		g_value_set_string (value, pk_package_get_summary (package));
+		break;
+	default:
+		/* only worked out when the row is drawn */
+		if (model->func != NULL)
+			model->func (model, package, state, column, value, model->func_data);
+		break;
+	}
+}
+
+static gboolean
+gpk_package_model_iter_next (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	GpkPackageModel *model = GPK_PACKAGE_MODEL (tree_model);
+	return gpk_package_model_iter_set (model, iter, gpk_package_model_iter_get (model, iter) + 1);
+}
+
+static gboolean
+gpk_package_model_iter_previous (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	GpkPackageModel *model = GPK_PACKAGE_MODEL (tree_model);
+	guint idx = gpk_package_model_iter_get (model, iter);
+	if (idx == 0) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	return gpk_package_model_iter_set (model, iter, idx - 1);
+}
+
+static gboolean
+gpk_package_model_iter_children (GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *parent)
+{
+	GpkPackageModel *model = GPK_PACKAGE_MODEL (tree_model);
+	if (parent != NULL) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	return gpk_package_model_iter_set (model, iter, 0);
+}
+
+static gboolean
+gpk_package_model_iter_has_child (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	return FALSE;
+}
+
+static gint
+gpk_package_model_iter_n_children (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	GpkPackageModel *model = GPK_PACKAGE_MODEL (tree_model);
+	if (iter != NULL)
+		return 0;
+	return gpk_package_model_get_n_rows (model);
+}
+
+static gboolean
+gpk_package_model_iter_nth_child (GtkTreeModel *tree_model, GtkTreeIter *iter,
+				  GtkTreeIter *parent, gint n)
+{
+	GpkPackageModel *model = GPK_PACKAGE_MODEL (tree_model);
+	if (parent != NULL || n < 0) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	return gpk_package_model_iter_set (model, iter, n);
+}
+
+static gboolean
+gpk_package_model_iter_parent (GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *child)
+{
+	iter->stamp = 0;
+	return FALSE;
+}
+
+static void
+gpk_package_model_tree_model_init (GtkTreeModelIface *iface)
+{
+	iface->get_flags = gpk_package_model_get_flags;
+	iface->get_n_columns = gpk_package_model_get_n_columns;
+	iface->get_column_type = gpk_package_model_get_column_type;
+	iface->get_iter = gpk_package_model_get_iter;
+	iface->get_path = gpk_package_model_get_path;
+	iface->get_value = gpk_package_model_get_value;
+	iface->iter_next = gpk_package_model_iter_next;
+	iface->iter_previous = gpk_package_model_iter_previous;
+	iface->iter_children = gpk_package_model_iter_children;
+	iface->iter_has_child = gpk_package_model_iter_has_child;
+	iface->iter_n_children = gpk_package_model_iter_n_children;
+	iface->iter_nth_child = gpk_package_model_iter_nth_child;
+	iface->iter_parent = gpk_package_model_iter_parent;
+}
+
+static gint
+gpk_package_model_compare (GpkPackageModel *model,
+			   PkPackage *a, guint rank_a,
+			   PkPackage *b, guint rank_b)
+{
+	gint rc = 0;
+
+	/* the most relevant first, unless the user picked a column */
+	if (model->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID) {
+		if (rank_a != rank_b)
+			return rank_a < rank_b ? -1 : 1;
+		rc = g_strcmp0 (pk_package_get_name (a), pk_package_get_name (b));
+		if (rc == 0)
+			rc = g_strcmp0 (pk_package_get_id (a), pk_package_get_id (b));
+		return rc;
+	}
+
+	switch (model->sort_column_id) {
+	case GPK_PACKAGE_MODEL_COLUMN_TEXT:
+		rc = g_strcmp0 (pk_package_get_name (a), pk_package_get_name (b));
+		if (rc == 0)
+			rc = g_strcmp0 (pk_package_get_id (a), pk_package_get_id (b));
+		break;
+	case GPK_PACKAGE_MODEL_COLUMN_SUMMARY:
+		rc = g_strcmp0 (pk_package_get_summary (a), pk_package_get_summary (b));
+		if (rc == 0)
+			rc = g_strcmp0 (pk_package_get_id (a), pk_package_get_id (b));
+		break;
+	default:
+		rc = g_strcmp0 (pk_package_get_id (a), pk_package_get_id (b));
+		break;
+	}
+	if (model->sort_order == GTK_SORT_DESCENDING)
+		rc = -rc;
+	return rc;
+}
+
+static gint
+gpk_package_model_sort_cb (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	GpkPackageModel *model = GPK_PACKAGE_MODEL (user_data);
+	gint rc;
+	guint idx_a = *((const gint *) a);
+	guint idx_b = *((const gint *) b);
+
+	rc = gpk_package_model_compare (model,
+					g_ptr_array_index (model->packages, idx_a),
+					g_array_index (model->ranks, guint, idx_a),
+					g_ptr_array_index (model->packages, idx_b),
+					g_array_index (model->ranks, guint, idx_b));
+
+	/* keep the existing order for equal rows */
+	if (rc == 0)
+		rc = idx_a < idx_b ? -1 : 1;
+	return rc;
+}
+
+static void
+gpk_package_model_sort (GpkPackageModel *model)
+{
+	GPtrArray *packages;
+	GArray *states;
+	GArray *ranks;
+	GArray *visible;
+	GtkTreePath *path;
+	guint i;
+	guint j;
+	guint k;
+	guint n_rows;
+	g_autofree gint *order = NULL;
+	g_autofree gint *added = NULL;
+	g_autofree gint *old_rows = NULL;
+	g_autofree gint *new_order = NULL;
+
+	if (model->sort_column_id == GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID)
+		return;
+	if (model->n_sorted >= model->packages->len)
+		return;
+	if (model->packages->len < 2) {
+		model->n_sorted = model->packages->len;
+		return;
+	}
+
+	/* only the new rows need sorting, then they are merged with the
+	 * rows that are already in order */
+	added = g_new (gint, model->packages->len - model->n_sorted);
+	for (i = model->n_sorted; i < model->packages->len; i++)
+		added[i - model->n_sorted] = i;
+	g_qsort_with_data (added, model->packages->len - model->n_sorted, sizeof (gint),
+			   gpk_package_model_sort_cb, model);
+	order = g_new (gint, model->packages->len);
+	for (i = 0, j = 0, k = 0; k < model->packages->len; k++) {
+		gint idx = i;
+		if (j >= model->packages->len - model->n_sorted ||
+		    (i < model->n_sorted &&
+		     gpk_package_model_sort_cb (&idx, &added[j], model) < 0))
+			order[k] = i++;
+		else
+			order[k] = added[j++];
+	}
+	model->n_sorted = model->packages->len;
+
+	/* work out where each row the view knows about has gone, the
+	 * message row always stays at the end */
+	n_rows = gpk_package_model_get_n_rows (model);
+	new_order = g_new (gint, n_rows);
+	if (model->message != NULL)
+		new_order[n_rows - 1] = n_rows - 1;
+	if (model->visible == NULL) {
+		for (i = 0; i < model->packages->len; i++)
+			new_order[i] = order[i];
+	} else {
+		old_rows = g_new (gint, model->packages->len);
+		for (i = 0; i < model->packages->len; i++)
+			old_rows[i] = -1;
+		for (i = 0; i < model->visible->len; i++)
+			old_rows[g_array_index (model->visible, guint, i)] = i;
+		visible = g_array_sized_new (FALSE, FALSE, sizeof (guint), model->visible->len);
+		for (i = 0; i < model->packages->len; i++) {
+			if (old_rows[order[i]] < 0)
+				continue;
+			new_order[visible->len] = old_rows[order[i]];
+			g_array_append_val (visible, i);
+		}
+		g_array_unref (model->visible);
+		model->visible = visible;
+	}
+
+	/* move the packages into the new order */
+	packages = g_ptr_array_new_full (model->packages->len, g_object_unref);
+	states = g_array_sized_new (FALSE, FALSE, sizeof (PkBitfield), model->packages->len);
+	ranks = g_array_sized_new (FALSE, FALSE, sizeof (guint), model->packages->len);
+	for (i = 0; i < model->packages->len; i++) {
+		g_ptr_array_add (packages, g_object_ref (g_ptr_array_index (model->packages, order[i])));
+		g_array_append_val (states, g_array_index (model->states, PkBitfield, order[i]));
+		g_array_append_val (ranks, g_array_index (model->ranks, guint, order[i]));
+	}
+	g_ptr_array_unref (model->packages);
+	g_array_unref (model->states);
+	g_array_unref (model->ranks);
+	model->packages = packages;
+	model->states = states;
+	model->ranks = ranks;
+	model->index_valid = FALSE;
+	if (n_rows == 0)
+		return;
+
+	path = gtk_tree_path_new ();
+	gtk_tree_model_rows_reordered (GTK_TREE_MODEL (model), path, NULL, new_order);
+	gtk_tree_path_free (path);
+}
+
+static gboolean
+gpk_package_model_get_sort_column_id (GtkTreeSortable *sortable,
+				      gint *sort_column_id,
+				      GtkSortType *order)
+{
+	GpkPackageModel *model = GPK_PACKAGE_MODEL (sortable);
+	if (sort_column_id != NULL)
+		*sort_column_id = model->sort_column_id;
+	if (order != NULL)
+		*order = model->sort_order;
+	return model->sort_column_id >= 0;
+}
+
+static void
+gpk_package_model_set_sort_column_id (GtkTreeSortable *sortable,
+				      gint sort_column_id,
+				      GtkSortType order)
+{
+	GpkPackageModel *model = GPK_PACKAGE_MODEL (sortable);
+
+	if (model->sort_column_id == sort_column_id && model->sort_order == order)
+		return;
+	model->sort_column_id = sort_column_id;
+	model->sort_order = order;
+	model->n_sorted = 0;
+	gtk_tree_sortable_sort_column_changed (sortable);
+	gpk_package_model_sort (model);
+}
+
+static void
+gpk_package_model_set_sort_func (GtkTreeSortable *sortable,
+				 gint sort_column_id,
+				 GtkTreeIterCompareFunc func,
+				 gpointer data,
+				 GDestroyNotify destroy)
+{
+	g_warning ("custom sort functions are not supported");
+}
+
+static void
+gpk_package_model_set_default_sort_func (GtkTreeSortable *sortable,
+					 GtkTreeIterCompareFunc func,
+					 gpointer data,
+					 GDestroyNotify destroy)
+{
+	g_warning ("custom sort functions are not supported");
+}
+
+/* the default sort is by rank, which is built in */
+static gboolean
+gpk_package_model_has_default_sort_func (GtkTreeSortable *sortable)
+{
+	return TRUE;
+}
+
+static void
+gpk_package_model_tree_sortable_init (GtkTreeSortableIface *iface)
+{
+	iface->get_sort_column_id = gpk_package_model_get_sort_column_id;
+	iface->set_sort_column_id = gpk_package_model_set_sort_column_id;
+	iface->set_sort_func = gpk_package_model_set_sort_func;
+	iface->set_default_sort_func = gpk_package_model_set_default_sort_func;
+	iface->has_default_sort_func = gpk_package_model_has_default_sort_func;
+}
+
+static void
+gpk_package_model_index_add (GpkPackageModel *model, guint idx)
+{
+	PkPackage *package;
+
+	if (!model->index_valid)
+		return;
+	package = g_ptr_array_index (model->packages, idx);
+	g_hash_table_insert (model->ids,
+			     (gpointer) pk_package_get_id (package),
+			     GUINT_TO_POINTER (idx + 1));
+
+	/* the first row with each name wins */
+	if (g_hash_table_contains (model->names, pk_package_get_name (package)))
+		return;
+	g_hash_table_insert (model->names,
+			     (gpointer) pk_package_get_name (package),
+			     GUINT_TO_POINTER (idx + 1));
+}
+
+static void
+gpk_package_model_index_ensure (GpkPackageModel *model)
+{
+	guint i;
+
+	if (model->index_valid)
+		return;
+	g_hash_table_remove_all (model->names);
+	g_hash_table_remove_all (model->ids);
+	model->index_valid = TRUE;
+	for (i = 0; i < model->packages->len; i++)
+		gpk_package_model_index_add (model, i);
+}
+
+static void
+gpk_package_model_row_inserted (GpkPackageModel *model, guint idx)
+{
+	GtkTreeIter iter;
+	GtkTreePath *path;
+
+	gpk_package_model_iter_set (model, &iter, idx);
+	path = gtk_tree_path_new_from_indices (idx, -1);
+	gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, &iter);
+	gtk_tree_path_free (path);
+}
+
+static void
+gpk_package_model_row_changed (GpkPackageModel *model, guint idx)
+{
+	GtkTreeIter iter;
+	GtkTreePath *path;
+
+	gpk_package_model_iter_set (model, &iter, idx);
+	path = gtk_tree_path_new_from_indices (idx, -1);
+	gtk_tree_model_row_changed (GTK_TREE_MODEL (model), path, &iter);
+	gtk_tree_path_free (path);
+}
+
+static void
+gpk_package_model_row_deleted (GpkPackageModel *model, guint row)
+{
+	GtkTreePath *path;
+
+	path = gtk_tree_path_new_from_indices (row, -1);
+	gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
+	gtk_tree_path_free (path);
+}
+
+/* shows exactly the packages that @show is %TRUE for, in package order */
+static void
+gpk_package_model_update_visible (GpkPackageModel *model, const gboolean *show)
+{
+	gboolean was_shown;
+	guint idx;
+	g_autoptr(GArray) visible_old = NULL;
+
+	/* every package is shown at the moment */
+	if (model->visible == NULL) {
+		model->visible = g_array_sized_new (FALSE, FALSE, sizeof (guint),
+						    model->packages->len);
+		for (idx = 0; idx < model->packages->len; idx++)
+			g_array_append_val (model->visible, idx);
+	}
+
+	visible_old = model->visible;
+	model->visible = g_array_sized_new (FALSE, FALSE, sizeof (guint), visible_old->len);
+	model->visible_old = visible_old;
+	model->visible_old_pos = 0;
+	for (idx = 0; idx < model->packages->len; idx++) {
+		was_shown = model->visible_old_pos < visible_old->len &&
+			    g_array_index (visible_old, guint, model->visible_old_pos) == idx;
+		if (was_shown)
+			model->visible_old_pos++;
+		if (was_shown && show[idx]) {
+			g_array_append_val (model->visible, idx);
+		} else if (was_shown) {
+			gpk_package_model_row_deleted (model, model->visible->len);
+		} else if (show[idx]) {
+			g_array_append_val (model->visible, idx);
+			gpk_package_model_row_inserted (model, model->visible->len - 1);
+		}
+	}
+	model->visible_old = NULL;
+}
+
+static gboolean
+gpk_package_model_is_installed (PkPackage *package)
+{
+	PkInfoEnum info = pk_package_get_info (package);
+	return info == PK_INFO_ENUM_INSTALLED ||
+	       info == PK_INFO_ENUM_COLLECTION_INSTALLED;
+}
+
+static gchar *
+gpk_package_model_get_newest_key (PkPackage *package)
+{
+	return g_strdup_printf ("%s;%s",
+				pk_package_get_name (package),
+				pk_package_get_arch (package));
+}
+
+/* returns the package that used to be the newest, if it no longer is */
+static PkPackage *
+gpk_package_model_newest_add (GpkPackageModel *model, PkPackage *package)
+{
+	PkPackage *newest;
+	g_autofree gchar *key = NULL;
+
+	/* installed packages are always shown */
+	if (gpk_package_model_is_installed (package))
+		return NULL;
+
+	key = gpk_package_model_get_newest_key (package);
+	newest = g_hash_table_lookup (model->newest, key);
+	if (newest != NULL &&
+	    gpk_vercmp (pk_package_get_version (package),
+			pk_package_get_version (newest)) <= 0)
+		return NULL;
+	g_hash_table_insert (model->newest, g_steal_pointer (&key), package);
+	return newest;
+}
+
+static gboolean
+gpk_package_model_is_visible (GpkPackageModel *model, PkPackage *package)
+{
+	gboolean installed;
+	g_autofree gchar *key = NULL;
+
+	installed = gpk_package_model_is_installed (package);
+	if (pk_bitfield_contain (model->filters, PK_FILTER_ENUM_INSTALLED) && !installed)
+		return FALSE;
+	if (pk_bitfield_contain (model->filters, PK_FILTER_ENUM_NOT_INSTALLED) && installed)
+		return FALSE;
+	if (pk_bitfield_contain (model->filters, PK_FILTER_ENUM_ARCH) &&
+	    !gpk_arch_is_native (pk_package_get_arch (package)))
+		return FALSE;
+	if (pk_bitfield_contain (model->filters, PK_FILTER_ENUM_NOT_ARCH) &&
+	    gpk_arch_is_native (pk_package_get_arch (package)))
+		return FALSE;
+	if (pk_bitfield_contain (model->filters, PK_FILTER_ENUM_NEWEST) && !installed) {
+		key = gpk_package_model_get_newest_key (package);
+		if (g_hash_table_lookup (model->newest, key) != package)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static void
+gpk_package_model_hide (GpkPackageModel *model, PkPackage *package)
+{
+	guint idx;
+	guint row;
+
+	gpk_package_model_index_ensure (model);
+	idx = GPOINTER_TO_UINT (g_hash_table_lookup (model->ids, pk_package_get_id (package)));
+	if (idx == 0 || g_ptr_array_index (model->packages, idx - 1) != package)
+		return;
+	if (!gpk_package_model_index_is_shown (model, idx - 1, &row))
+		return;
+	g_array_remove_index (model->visible, row);
+	gpk_package_model_row_deleted (model, row);
+}
+
+/* shows the packages that match the filters, signalling only the changes */
+static void
+gpk_package_model_refilter (GpkPackageModel *model)
+{
+	guint i;
+	g_autofree gboolean *show = NULL;
+
+	/* the newest versions are only known once every package is seen */
+	g_hash_table_remove_all (model->newest);
+	if (pk_bitfield_contain (model->filters, PK_FILTER_ENUM_NEWEST)) {
+		for (i = 0; i < model->packages->len; i++)
+			gpk_package_model_newest_add (model, g_ptr_array_index (model->packages, i));
+	}
+	show = g_new (gboolean, model->packages->len);
+	for (i = 0; i < model->packages->len; i++)
+		show[i] = gpk_package_model_is_visible (model, g_ptr_array_index (model->packages, i));
+	gpk_package_model_update_visible (model, show);
+}
+
+/**
+ * gpk_package_model_set_filters:
+ * @model: a #GpkPackageModel
+ * @filters: a #PkBitfield of #PkFilterEnum
+ *
+ * Only shows the packages that match @filters. The installed, arch and
+ * newest filters and their opposites are understood, anything else is
+ * ignored. Only the rows that appear or disappear are signalled.
+ *
+ * Return value: %TRUE if the rows were changed
+ **/
+gboolean
+gpk_package_model_set_filters (GpkPackageModel *model, PkBitfield filters)
+{
+	g_return_val_if_fail (GPK_IS_PACKAGE_MODEL (model), FALSE);
+
+	filters &= pk_bitfield_from_enums (PK_FILTER_ENUM_INSTALLED,
+					   PK_FILTER_ENUM_NOT_INSTALLED,
+					   PK_FILTER_ENUM_ARCH,
+					   PK_FILTER_ENUM_NOT_ARCH,
+					   PK_FILTER_ENUM_NEWEST,
+					   -1);
+	if (model->filters == filters)
+		return FALSE;
+	model->filters = filters;
+	gpk_package_model_refilter (model);
+	model->stamp++;
+
+	/* nothing is hidden */
+	if (filters == 0)
+		g_clear_pointer (&model->visible, g_array_unref);
+	return TRUE;
+}
+
+/**
+ * gpk_package_model_set_func:
+ *
+ * Sets the function used to work out the image, checkbox and text
+ * columns of a package row.
+ **/
+void
+gpk_package_model_set_func (GpkPackageModel *model,
+			    GpkPackageModelFunc func,
+			    gpointer user_data)
+{
+	g_return_if_fail (GPK_IS_PACKAGE_MODEL (model));
+	model->func = func;
+	model->func_data = user_data;
+}
+
+/**
+ * gpk_package_model_clear:
+ **/
+void
+gpk_package_model_clear (GpkPackageModel *model)
+{
+	GtkTreePath *path;
+	guint i;
+
+	g_return_if_fail (GPK_IS_PACKAGE_MODEL (model));
+
+	/* remove from the end, so the view never has to shift rows */
+	for (i = gpk_package_model_get_n_rows (model); i > 0; i--) {
+		if (i > gpk_package_model_get_n_shown (model)) {
+			g_clear_pointer (&model->message, g_free);
+			g_clear_pointer (&model->message_icon, g_free);
+		} else if (model->visible != NULL) {
+			g_array_set_size (model->visible, i - 1);
+		} else {
+			g_ptr_array_remove_index (model->packages, i - 1);
+			g_array_remove_index (model->states, i - 1);
+			g_array_remove_index (model->ranks, i - 1);
+		}
+		path = gtk_tree_path_new_from_indices (i - 1, -1);
+		gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
+		gtk_tree_path_free (path);
+	}
+
+	/* and the packages that were not shown */
+	g_ptr_array_set_size (model->packages, 0);
+	g_array_set_size (model->states, 0);
+	g_array_set_size (model->ranks, 0);
+	model->n_sorted = 0;
+	g_hash_table_remove_all (model->newest);
+	g_hash_table_remove_all (model->names);
+	g_hash_table_remove_all (model->ids);
+	model->index_valid = TRUE;
+	model->stamp++;
+}
+
+/**
+ * gpk_package_model_add:
+ *
+ * Adds a package with the best rank.
+ **/
+void
+gpk_package_model_add (GpkPackageModel *model, PkPackage *package, PkBitfield state)
+{
+	gpk_package_model_add_ranked (model, package, state, 0);
+}
+
+/**
+ * gpk_package_model_add_ranked:
+ * @model: a #GpkPackageModel
+ * @package: a #PkPackage
+ * @state: the state of the row
+ * @rank: where the row goes, lower ranks are shown first by the default sort
+ *
+ * Adds a package after the other rows. If the model is sorted, call
+ * gpk_package_model_sort_added() once the batch has been added to move
+ * the new rows into place. The package is not shown if it does not
+ * match the filters.
+ **/
+void
+gpk_package_model_add_ranked (GpkPackageModel *model,
+			      PkPackage *package,
+			      PkBitfield state,
+			      guint rank)
+{
+	PkPackage *newest_old = NULL;
+	guint idx;
+	guint row;
+
+	g_return_if_fail (GPK_IS_PACKAGE_MODEL (model));
+	g_return_if_fail (PK_IS_PACKAGE (package));
+
+	idx = model->packages->len;
+	g_ptr_array_add (model->packages, g_object_ref (package));
+	g_array_append_val (model->states, state);
+	g_array_append_val (model->ranks, rank);
+	gpk_package_model_index_add (model, idx);
+	if (model->visible == NULL) {
+		gpk_package_model_row_inserted (model, idx);
+		return;
+	}
+
+	/* a newer version hides the old one */
+	if (pk_bitfield_contain (model->filters, PK_FILTER_ENUM_NEWEST))
+		newest_old = gpk_package_model_newest_add (model, package);
+	if (newest_old != NULL)
+		gpk_package_model_hide (model, newest_old);
+	if (!gpk_package_model_is_visible (model, package))
+		return;
+	row = model->visible->len;
+	g_array_append_val (model->visible, idx);
+	gpk_package_model_row_inserted (model, row);
+}
+
+/**
+ * gpk_package_model_sort_added:
+ * @model: a #GpkPackageModel
+ *
+ * Moves the rows added since the last call into their sorted place,
+ * emitting a single rows-reordered signal.
+ **/
+void
+gpk_package_model_sort_added (GpkPackageModel *model)
+{
+	g_return_if_fail (GPK_IS_PACKAGE_MODEL (model));
+	gpk_package_model_sort (model);
+}
+
+/**
+ * gpk_package_model_add_message:
+ *
+ * Shows a row of text after the packages, replacing any old message.
+ **/
+void
+gpk_package_model_add_message (GpkPackageModel *model, const gchar *icon_name, const gchar *text)
+{
+	gboolean existing;
+
+	g_return_if_fail (GPK_IS_PACKAGE_MODEL (model));
+
+	existing = model->message != NULL;
+	g_free (model->message);
+	g_free (model->message_icon);
+	model->message = g_strdup (text);
+	model->message_icon = g_strdup (icon_name);
+	if (existing)
+		gpk_package_model_row_changed (model, gpk_package_model_get_n_shown (model));
+	else
+		gpk_package_model_row_inserted (model, gpk_package_model_get_n_shown (model));
+}
+
+/**
+ * gpk_package_model_get_size:
+ *
+ * Return value: the number of packages shown, not counting any message
+ **/
+guint
+gpk_package_model_get_size (GpkPackageModel *model)
+{
+	g_return_val_if_fail (GPK_IS_PACKAGE_MODEL (model), 0);
+	return gpk_package_model_get_n_shown (model);
+}
+
+/**
+ * gpk_package_model_get_package:
+ *
+ * Return value: the package for the row, or %NULL for the message row
+ **/
+PkPackage *
+gpk_package_model_get_package (GpkPackageModel *model, GtkTreeIter *iter)
+{
+	guint idx;
+
+	g_return_val_if_fail (GPK_IS_PACKAGE_MODEL (model), NULL);
+
+	idx = gpk_package_model_iter_get (model, iter);
+	if (idx >= gpk_package_model_get_n_shown (model))
+		return NULL;
+	return g_ptr_array_index (model->packages, gpk_package_model_row_to_index (model, idx));
+}
+
+/**
+ * gpk_package_model_get_state:
+ **/
+PkBitfield
+gpk_package_model_get_state (GpkPackageModel *model, GtkTreeIter *iter)
+{
+	guint idx;
+
+	g_return_val_if_fail (GPK_IS_PACKAGE_MODEL (model), 0);
+
+	idx = gpk_package_model_iter_get (model, iter);
+	if (idx >= gpk_package_model_get_n_shown (model))
+		return 0;
+	return g_array_index (model->states, PkBitfield, gpk_package_model_row_to_index (model, idx));
+}
+
+/**
+ * gpk_package_model_set_state:
+ **/
+void
+gpk_package_model_set_state (GpkPackageModel *model, GtkTreeIter *iter, PkBitfield state)
+{
+	guint row;
+	guint idx;
+
+	g_return_if_fail (GPK_IS_PACKAGE_MODEL (model));
+
+	row = gpk_package_model_iter_get (model, iter);
+	if (row >= gpk_package_model_get_n_shown (model))
+		return;
+	idx = gpk_package_model_row_to_index (model, row);
+	if (g_array_index (model->states, PkBitfield, idx) == state)
+		return;
+	g_array_index (model->states, PkBitfield, idx) = state;
+	gpk_package_model_row_changed (model, row);
+}
+
+/**
+ * gpk_package_model_refresh:
+ * @model: a #GpkPackageModel
+ * @start: the first row to check
+ * @end: the last row to check
+ * @mask: the state bits to compare
+ * @value: what the masked state must be for the row to be redrawn
+ *
+ * Tells the view to redraw the rows between @start and @end whose
+ * #GpkPackageModelFunc output would now be different. Rows outside the
+ * range are worked out again anyway when they are next drawn.
+ **/
+void
+gpk_package_model_refresh (GpkPackageModel *model,
+			   GtkTreePath *start,
+			   GtkTreePath *end,
+			   PkBitfield mask,
+			   PkBitfield value)
+{
+	guint i;
+	guint idx_end;
+	PkBitfield state;
+
+	g_return_if_fail (GPK_IS_PACKAGE_MODEL (model));
+
+	idx_end = MIN ((guint) gtk_tree_path_get_indices (end)[0] + 1,
+		       gpk_package_model_get_n_shown (model));
+	for (i = gtk_tree_path_get_indices (start)[0]; i < idx_end; i++) {
+		state = g_array_index (model->states, PkBitfield,
+				       gpk_package_model_row_to_index (model, i));
+		if ((state & mask) == value)
+			gpk_package_model_row_changed (model, i);
+	}
+}
+
+/**
+ * gpk_package_model_filter:
+ *
+ * Removes every package that @func returns %FALSE for, whether it is
+ * shown or not, and any message row. The rows that are kept stay in
+ * the same order, and only the removed rows are signalled.
+ *
+ * Return value: the number of package rows removed
+ **/
+guint
+gpk_package_model_filter (GpkPackageModel *model,
+			  GpkPackageModelFilterFunc func,
+			  gpointer user_data)
+{
+	guint i;
+	guint idx;
+	guint removed = 0;
+	guint n_sorted = 0;
+	GPtrArray *packages;
+	GArray *states;
+	GArray *ranks;
+	g_autofree gboolean *keep = NULL;
+	g_autofree gboolean *show = NULL;
+	g_autofree guint *new_idx = NULL;
+
+	g_return_val_if_fail (GPK_IS_PACKAGE_MODEL (model), 0);
+
+	keep = g_new (gboolean, model->packages->len);
+	for (idx = 0; idx < model->packages->len; idx++) {
+		keep[idx] = func (g_ptr_array_index (model->packages, idx), user_data);
+		if (!keep[idx])
+			removed++;
+	}
+	if (removed == 0 && model->message == NULL)
+		return 0;
+
+	/* the message row goes first, it is always last */
+	if (model->message != NULL) {
+		g_clear_pointer (&model->message, g_free);
+		g_clear_pointer (&model->message_icon, g_free);
+		gpk_package_model_row_deleted (model, gpk_package_model_get_n_shown (model));
+	}
+	if (removed == 0)
+		return 0;
+
+	/* only the shown rows that are removed are signalled */
+	show = g_new0 (gboolean, model->packages->len);
+	if (model->visible == NULL) {
+		for (idx = 0; idx < model->packages->len; idx++)
+			show[idx] = keep[idx];
+	} else {
+		for (i = 0; i < model->visible->len; i++) {
+			idx = g_array_index (model->visible, guint, i);
+			show[idx] = keep[idx];
+		}
+	}
+	gpk_package_model_update_visible (model, show);
+
+	/* the row numbers do not change when the packages are packed
+	 * together, so the view does not need to know */
+	new_idx = g_new (guint, model->packages->len);
+	packages = g_ptr_array_new_full (model->packages->len - removed, g_object_unref);
+	states = g_array_sized_new (FALSE, FALSE, sizeof (PkBitfield), model->packages->len - removed);
+	ranks = g_array_sized_new (FALSE, FALSE, sizeof (guint), model->packages->len - removed);
+	for (idx = 0; idx < model->packages->len; idx++) {
+		new_idx[idx] = packages->len;
+		if (!keep[idx])
+			continue;
+		if (idx < model->n_sorted)
+			n_sorted++;
+		g_ptr_array_add (packages, g_object_ref (g_ptr_array_index (model->packages, idx)));
+		g_array_append_val (states, g_array_index (model->states, PkBitfield, idx));
+		g_array_append_val (ranks, g_array_index (model->ranks, guint, idx));
+	}
+	for (i = 0; i < model->visible->len; i++) {
+		idx = g_array_index (model->visible, guint, i);
+		g_array_index (model->visible, guint, i) = new_idx[idx];
+	}
+	g_ptr_array_unref (model->packages);
+	g_array_unref (model->states);
+	g_array_unref (model->ranks);
+	model->packages = packages;
+	model->states = states;
+	model->ranks = ranks;
+	model->n_sorted = n_sorted;
+	model->index_valid = FALSE;
+
+	/* an older version may now be the newest one left */
+	g_hash_table_remove_all (model->newest);
+	if (pk_bitfield_contain (model->filters, PK_FILTER_ENUM_NEWEST)) {
+		for (idx = 0; idx < model->packages->len; idx++)
+			gpk_package_model_newest_add (model, g_ptr_array_index (model->packages, idx));
+		g_free (show);
+		show = g_new (gboolean, model->packages->len);
+		for (idx = 0; idx < model->packages->len; idx++)
+			show[idx] = gpk_package_model_is_visible (model, g_ptr_array_index (model->packages, idx));
+		gpk_package_model_update_visible (model, show);
+	}
+	if (model->filters == 0)
+		g_clear_pointer (&model->visible, g_array_unref);
+	return removed;
+}
+
+/**
+ * gpk_package_model_find_name:
+ * @model: a #GpkPackageModel
+ * @name: a package name, e.g. "gnome-packagekit"
+ * @iter: (out): the first row with this name
+ *
+ * Return value: %TRUE if a package with this name is shown
+ **/
+gboolean
+gpk_package_model_find_name (GpkPackageModel *model, const gchar *name, GtkTreeIter *iter)
+{
+	PkPackage *package;
+	gpointer idx;
+	guint row;
+
+	g_return_val_if_fail (GPK_IS_PACKAGE_MODEL (model), FALSE);
+
+	if (name == NULL)
+		return FALSE;
+	gpk_package_model_index_ensure (model);
+	idx = g_hash_table_lookup (model->names, name);
+	if (idx == NULL)
+		return FALSE;
+	if (gpk_package_model_index_is_shown (model, GPOINTER_TO_UINT (idx) - 1, &row))
+		return gpk_package_model_iter_set (model, iter, row);
+
+	/* the first one is hidden, but another version may not be */
+	for (row = 0; row < gpk_package_model_get_n_shown (model); row++) {
+		package = g_ptr_array_index (model->packages, gpk_package_model_row_to_index (model, row));
+		if (g_strcmp0 (pk_package_get_name (package), name) == 0)
+			return gpk_package_model_iter_set (model, iter, row);
+	}
+	return FALSE;
+}
+
+/**
+ * gpk_package_model_find_id:
+ * @model: a #GpkPackageModel
+ * @package_id: a package-id
+ * @iter: (out): the row for this package
+ *
+ * Return value: %TRUE if the package is shown
+ **/
+gboolean
+gpk_package_model_find_id (GpkPackageModel *model, const gchar *package_id, GtkTreeIter *iter)
+{
+	gpointer idx;
+	guint row;
+
+	g_return_val_if_fail (GPK_IS_PACKAGE_MODEL (model), FALSE);
+
+	if (package_id == NULL)
+		return FALSE;
+	gpk_package_model_index_ensure (model);
+	idx = g_hash_table_lookup (model->ids, package_id);
+	if (idx == NULL)
+		return FALSE;
+	if (!gpk_package_model_index_is_shown (model, GPOINTER_TO_UINT (idx) - 1, &row))
+		return FALSE;
+	return gpk_package_model_iter_set (model, iter, row);
+}
+
+/**
+ * gpk_package_model_update:
+ * @model: a #GpkPackageModel
+ * @package: a newer copy of a #PkPackage in the model
+ * @state: the state of the row
+ *
+ * Replaces the package with the same package-id in place, so a row
+ * that was shown from old data is redrawn with the new data. If the
+ * model is sorted by summary, the row is only moved by the next
+ * gpk_package_model_sort_added().
+ *
+ * Return value: %TRUE if the package was in the model
+ **/
+gboolean
+gpk_package_model_update (GpkPackageModel *model, PkPackage *package, PkBitfield state)
+{
+	PkPackage *old;
+	gboolean installed_changed;
+	guint idx;
+	guint row;
+	g_autofree gchar *key = NULL;
+
+	g_return_val_if_fail (GPK_IS_PACKAGE_MODEL (model), FALSE);
+	g_return_val_if_fail (PK_IS_PACKAGE (package), FALSE);
+
+	gpk_package_model_index_ensure (model);
+	idx = GPOINTER_TO_UINT (g_hash_table_lookup (model->ids, pk_package_get_id (package)));
+	if (idx == 0)
+		return FALSE;
+	idx--;
+	old = g_ptr_array_index (model->packages, idx);
+	if (g_array_index (model->states, PkBitfield, idx) == state &&
+	    pk_package_get_info (old) == pk_package_get_info (package) &&
+	    g_strcmp0 (pk_package_get_summary (old), pk_package_get_summary (package)) == 0)
+		return TRUE;
+
+	/* the indexes point at the strings of the package they were added for */
+	g_hash_table_replace (model->ids, (gpointer) pk_package_get_id (package),
+			      GUINT_TO_POINTER (idx + 1));
+	if (GPOINTER_TO_UINT (g_hash_table_lookup (model->names, pk_package_get_name (old))) == idx + 1) {
+		g_hash_table_replace (model->names, (gpointer) pk_package_get_name (package),
+				      GUINT_TO_POINTER (idx + 1));
+	}
+	key = gpk_package_model_get_newest_key (package);
+	if (g_hash_table_lookup (model->newest, key) == old)
+		g_hash_table_insert (model->newest, g_steal_pointer (&key), package);
+
+	installed_changed = gpk_package_model_is_installed (old) !=
+			    gpk_package_model_is_installed (package);
+	if (model->sort_column_id == GPK_PACKAGE_MODEL_COLUMN_SUMMARY &&
+	    g_strcmp0 (pk_package_get_summary (old), pk_package_get_summary (package)) != 0)
+		model->n_sorted = MIN (model->n_sorted, idx);
+	g_ptr_array_index (model->packages, idx) = g_object_ref (package);
+	g_object_unref (old);
+	g_array_index (model->states, PkBitfield, idx) = state;
+
+	/* the filters may now show or hide it */
+	if (model->visible != NULL && installed_changed) {
+		gpk_package_model_refilter (model);
+		return TRUE;
+	}
+	if (gpk_package_model_index_is_shown (model, idx, &row))
+		gpk_package_model_row_changed (model, row);
+	return TRUE;
+}
+
+static void
+gpk_package_model_finalize (GObject *object)
+{
+	GpkPackageModel *model = GPK_PACKAGE_MODEL (object);
+
+	g_ptr_array_unref (model->packages);
+	g_array_unref (model->states);
+	g_array_unref (model->ranks);
+	g_hash_table_unref (model->names);
+	g_hash_table_unref (model->ids);
+	g_hash_table_unref (model->newest);
+	if (model->visible != NULL)
+		g_array_unref (model->visible);
+	g_free (model->message);
+	g_free (model->message_icon);
+
+	G_OBJECT_CLASS (gpk_package_model_parent_class)->finalize (object);
+}
+
+static void
+gpk_package_model_class_init (GpkPackageModelClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (class);
+	object_class->finalize = gpk_package_model_finalize;
+}
+
+static void
+gpk_package_model_init (GpkPackageModel *model)
+{
+	model->packages = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	model->states = g_array_new (FALSE, FALSE, sizeof (PkBitfield));
+	model->ranks = g_array_new (FALSE, FALSE, sizeof (guint));
+	model->names = g_hash_table_new (g_str_hash, g_str_equal);
+	model->ids = g_hash_table_new (g_str_hash, g_str_equal);
+	model->newest = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	model->index_valid = TRUE;
+	model->stamp = g_random_int ();
+	model->sort_column_id = GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID;
+	model->sort_order = GTK_SORT_ASCENDING;
+}
+
+/**
+ * gpk_package_model_new:
+ **/
+GpkPackageModel *
+gpk_package_model_new (void)
+{
+	return g_object_new (GPK_TYPE_PACKAGE_MODEL, NULL);
+}
@@ -0,0 +1,103 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2007-2013 Richard Hughes <richard@hughsie.com>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef GPK_PACKAGE_MODEL_H
+#define GPK_PACKAGE_MODEL_H
+
+#include <glib-object.h>
+#include <gtk/gtk.h>
+#include <packagekit-glib2/packagekit.h>
+
+G_BEGIN_DECLS
+
+#define GPK_TYPE_PACKAGE_MODEL (gpk_package_model_get_type())
+G_DECLARE_FINAL_TYPE (GpkPackageModel, gpk_package_model, GPK, PACKAGE_MODEL, GObject)
+
+typedef enum {
+	GPK_PACKAGE_MODEL_COLUMN_IMAGE,
+	GPK_PACKAGE_MODEL_COLUMN_STATE,  /* state of the item */
+	GPK_PACKAGE_MODEL_COLUMN_CHECKBOX,  /* what we show in the checkbox */
+	GPK_PACKAGE_MODEL_COLUMN_CHECKBOX_VISIBLE, /* visible */
+	GPK_PACKAGE_MODEL_COLUMN_TEXT,
+	GPK_PACKAGE_MODEL_COLUMN_ID,
+	GPK_PACKAGE_MODEL_COLUMN_SUMMARY,
+	GPK_PACKAGE_MODEL_COLUMN_LAST
+} GpkPackageModelColumn;
+
+/* fills in the columns that are worked out from the package and state */
+typedef void	 (*GpkPackageModelFunc)			(GpkPackageModel	*model,
+							 PkPackage		*package,
+							 PkBitfield		 state,
+							 GpkPackageModelColumn	 column,
+							 GValue			*value,
+							 gpointer		 user_data);
+
+/* return FALSE to remove the row */
+typedef gboolean (*GpkPackageModelFilterFunc)		(PkPackage		*package,
+							 gpointer		 user_data);
+
+GpkPackageModel	*gpk_package_model_new			(void);
+void		 gpk_package_model_set_func		(GpkPackageModel	*model,
+							 GpkPackageModelFunc	 func,
+							 gpointer		 user_data);
+gboolean	 gpk_package_model_set_filters		(GpkPackageModel	*model,
+							 PkBitfield		 filters);
+void		 gpk_package_model_clear		(GpkPackageModel	*model);
+void		 gpk_package_model_add			(GpkPackageModel	*model,
+							 PkPackage		*package,
+							 PkBitfield		 state);
+void		 gpk_package_model_add_ranked		(GpkPackageModel	*model,
+							 PkPackage		*package,
+							 PkBitfield		 state,
+							 guint			 rank);
+void		 gpk_package_model_sort_added		(GpkPackageModel	*model);
+gboolean	 gpk_package_model_update		(GpkPackageModel	*model,
+							 PkPackage		*package,
+							 PkBitfield		 state);
+void		 gpk_package_model_add_message		(GpkPackageModel	*model,
+							 const gchar		*icon_name,
+							 const gchar		*text);
+guint		 gpk_package_model_get_size		(GpkPackageModel	*model);
+PkPackage	*gpk_package_model_get_package		(GpkPackageModel	*model,
+							 GtkTreeIter		*iter);
+PkBitfield	 gpk_package_model_get_state		(GpkPackageModel	*model,
+							 GtkTreeIter		*iter);
+void		 gpk_package_model_set_state		(GpkPackageModel	*model,
+							 GtkTreeIter		*iter,
+							 PkBitfield		 state);
+void		 gpk_package_model_refresh		(GpkPackageModel	*model,
+							 GtkTreePath		*start,
+							 GtkTreePath		*end,
+							 PkBitfield		 mask,
+							 PkBitfield		 value);
+gboolean	 gpk_package_model_find_name		(GpkPackageModel	*model,
+							 const gchar		*name,
+							 GtkTreeIter		*iter);
+gboolean	 gpk_package_model_find_id		(GpkPackageModel	*model,
+							 const gchar		*package_id,
+							 GtkTreeIter		*iter);
+guint		 gpk_package_model_filter		(GpkPackageModel	*model,
+							 GpkPackageModelFilterFunc func,
+							 gpointer		 user_data);
+
+G_END_DECLS
+
+#endif /* GPK_PACKAGE_MODEL_H */
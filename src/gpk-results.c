@@ -0,0 +1,160 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2007-2013 Richard Hughes <richard@hughsie.com>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+#include <packagekit-glib2/packagekit.h>
+
+#include "gpk-results.h"
+
+#define GPK_RESULTS_RANK_EXACT		400 /* score */
+#define GPK_RESULTS_RANK_PREFIX		200 /* score */
+#define GPK_RESULTS_RANK_TOKEN		100 /* score */
+#define GPK_RESULTS_RANK_NAME		50 /* score */
+#define GPK_RESULTS_RANK_SUMMARY	10 /* score */
+#define GPK_RESULTS_RANK_INSTALLED	5 /* score */
+
+/**
+ * gpk_results_score:
+ *
+ * Scores a search result against the lower case search terms, where
+ * higher is better. This is safe to call from a worker thread.
+ **/
+guint
+gpk_results_score (PkPackage *package, gchar **terms)
+{
+	const gchar *summary;
+	guint i;
+	guint score = 0;
+	PkInfoEnum info;
+	g_autofree gchar *name = NULL;
+	g_autofree gchar *summary_lower = NULL;
+	g_auto(GStrv) tokens = NULL;
+
+	name = g_utf8_strdown (pk_package_get_name (package), -1);
+	summary = pk_package_get_summary (package);
+	if (summary != NULL)
+		summary_lower = g_utf8_strdown (summary, -1);
+	tokens = g_strsplit_set (name, "-_.+", -1);
+	for (i = 0; terms[i] != NULL; i++) {
+		if (g_strcmp0 (name, terms[i]) == 0)
+			score += GPK_RESULTS_RANK_EXACT;
+		else if (g_str_has_prefix (name, terms[i]))
+			score += GPK_RESULTS_RANK_PREFIX;
+		else if (g_strv_contains ((const gchar * const *) tokens, terms[i]))
+			score += GPK_RESULTS_RANK_TOKEN;
+		else if (strstr (name, terms[i]) != NULL)
+			score += GPK_RESULTS_RANK_NAME;
+		if (summary_lower != NULL && strstr (summary_lower, terms[i]) != NULL)
+			score += GPK_RESULTS_RANK_SUMMARY;
+	}
+
+	info = pk_package_get_info (package);
+	if (info == PK_INFO_ENUM_INSTALLED || info == PK_INFO_ENUM_COLLECTION_INSTALLED)
+		score += GPK_RESULTS_RANK_INSTALLED;
+	return score;
+}
+
+static gint
+gpk_results_sort_cb (gconstpointer a, gconstpointer b)
+{
+	const GpkResultsItem *item_a = a;
+	const GpkResultsItem *item_b = b;
+
+	if (item_a->rank < item_b->rank)
+		return -1;
+	if (item_a->rank > item_b->rank)
+		return 1;
+	return 0;
+}
+
+/**
+ * gpk_results_rank:
+ *
+ * Ranks the packages against the search terms, or keeps the order
+ * they arrived in if @terms is %NULL.
+ *
+ * The items only borrow the packages, so the caller has to keep
+ * @packages alive or take a reference on each one.
+ *
+ * Return value: an array of #GpkResultsItem, best first
+ **/
+GArray *
+gpk_results_rank (GPtrArray *packages, gchar **terms)
+{
+	GArray *ranked;
+	GpkResultsItem item;
+	guint i;
+
+	ranked = g_array_sized_new (FALSE, FALSE, sizeof (GpkResultsItem), packages->len);
+	for (i = 0; i < packages->len; i++) {
+		item.package = g_ptr_array_index (packages, i);
+		item.rank = 0;
+		if (terms != NULL)
+			item.rank = G_MAXUINT - gpk_results_score (item.package, terms);
+		g_array_append_val (ranked, item);
+	}
+	if (terms != NULL)
+		g_array_sort (ranked, gpk_results_sort_cb);
+	return ranked;
+}
+
+/**
+ * gpk_results_add:
+ * @budget: the time in ms to spend, or 0 to add everything
+ * @func: (allow-none): adds a single row, or %NULL to add with no state
+ *
+ * Adds rows from the front of @ranked until the budget is used up,
+ * removes them from the array and then moves them into place with
+ * one signal, so a large result set never stalls redraws or input.
+ *
+ * Return value: the number of rows added
+ **/
+guint
+gpk_results_add (GpkPackageModel *model,
+		 GArray *ranked,
+		 guint budget,
+		 GpkResultsAddFunc func,
+		 gpointer user_data)
+{
+	GpkResultsItem *item;
+	gint64 deadline = 0;
+	guint i;
+
+	if (budget > 0)
+		deadline = g_get_monotonic_time () + budget * 1000;
+	for (i = 0; i < ranked->len; i++) {
+		item = &g_array_index (ranked, GpkResultsItem, i);
+		if (func != NULL)
+			func (model, item->package, item->rank, user_data);
+		else
+			gpk_package_model_add_ranked (model, item->package, 0, item->rank);
+		if (deadline > 0 && g_get_monotonic_time () > deadline) {
+			i++;
+			break;
+		}
+	}
+	g_array_remove_range (ranked, 0, i);
+	gpk_package_model_sort_added (model);
+	return i;
+}
@@ -0,0 +1,56 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2007-2013 Richard Hughes <richard@hughsie.com>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef GPK_RESULTS_H
+#define GPK_RESULTS_H
+
+#include <glib.h>
+#include <packagekit-glib2/packagekit.h>
+
+#include "gpk-package-model.h"
+
+G_BEGIN_DECLS
+
+#define GPK_RESULTS_BUDGET		8 /* ms */
+
+typedef struct {
+	PkPackage		*package;
+	guint			 rank;		/* lower is better */
+} GpkResultsItem;
+
+typedef void	 (*GpkResultsAddFunc)			(GpkPackageModel	*model,
+							 PkPackage		*package,
+							 guint			 rank,
+							 gpointer		 user_data);
+
+guint		 gpk_results_score			(PkPackage		*package,
+							 gchar			**terms);
+GArray		*gpk_results_rank			(GPtrArray		*packages,
+							 gchar			**terms);
+guint		 gpk_results_add			(GpkPackageModel	*model,
+							 GArray			*ranked,
+							 guint			 budget,
+							 GpkResultsAddFunc	 func,
+							 gpointer		 user_data);
+
+G_END_DECLS
+
+#endif /* GPK_RESULTS_H */
@@ -21,11 +21,18 @@
 
 #include <glib.h>
 #include <glib-object.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
 
+#include "gpk-catalog.h"
 #include "gpk-common.h"
 #include "gpk-enum.h"
 #include "gpk-error.h"
+#include "gpk-file-model.h"
+#include "gpk-package-model.h"
+#include "gpk-results.h"
 #include "gpk-task.h"
+#include "gpk-trigram-index.h"
 
 static void
 gpk_test_enum_func (void)
@@ -167,6 +174,549 @@ gpk_test_common_func (void)
 	text = gpk_package_id_format_twoline (NULL, "simon;0.0.1;;data", "dude");
 	g_assert_cmpstr (text, ==, "dude\n<span color=\"gray\">simon-0.0.1</span>");
 	g_free (text);
+
+	/* versions */
+	g_assert_cmpint (gpk_vercmp ("1.0", "1.0"), ==, 0);
+	g_assert_cmpint (gpk_vercmp ("1.10", "1.9"), >, 0);
+	g_assert_cmpint (gpk_vercmp ("1.0-2", "1.0.1-1"), <, 0);
+	g_assert_cmpint (gpk_vercmp ("1.0-10.fc35", "1.0-9.fc35"), >, 0);
+	g_assert_cmpint (gpk_vercmp ("1:1.0", "2.0"), >, 0);
+	g_assert_cmpint (gpk_vercmp ("1.0~rc1", "1.0"), <, 0);
+	g_assert_cmpint (gpk_vercmp ("1.0a", "1.0"), >, 0);
+	g_assert_cmpint (gpk_vercmp ("1.0^git1", "1.0"), >, 0);
+	g_assert_cmpint (gpk_vercmp ("1.0^git1", "1.0.1"), <, 0);
+	g_assert_cmpint (gpk_vercmp ("1.0~rc1^git1", "1.0~rc1"), >, 0);
+	g_assert_cmpint (gpk_vercmp ("1.0~rc1^git1", "1.0"), <, 0);
+
+	/* architectures */
+	g_assert (gpk_arch_is_native ("noarch"));
+	g_assert (gpk_arch_is_native (""));
+	g_assert (!gpk_arch_is_native ("nonesuch"));
+
+	/* a 32 bit userland on a 64 bit kernel */
+	gpk_arch_set_native ("armhf");
+	g_assert (gpk_arch_is_native ("armv7hl"));
+	g_assert (!gpk_arch_is_native ("aarch64"));
+	gpk_arch_set_native (NULL);
+}
+
+static void
+gpk_test_package_model_func (void)
+{
+	GpkPackageModel *model;
+	GtkTreeIter iter;
+	PkPackage *package;
+	gboolean ret;
+	const gchar *ids[] = { "zed;1.0;x86_64;fedora",
+			       "alpha;1.0;x86_64;fedora",
+			       "mid;1.0;x86_64;fedora",
+			       NULL };
+	guint i;
+	g_autofree gchar *package_id = NULL;
+	g_autofree gchar *text = NULL;
+
+	model = gpk_package_model_new ();
+	for (i = 0; ids[i] != NULL; i++) {
+		package = pk_package_new ();
+		pk_package_set_id (package, ids[i], NULL);
+		gpk_package_model_add (model, package, 0);
+		g_object_unref (package);
+	}
+	g_assert_cmpint (gpk_package_model_get_size (model), ==, 3);
+
+	/* sort by package-id */
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (model),
+					      GPK_PACKAGE_MODEL_COLUMN_ID,
+					      GTK_SORT_ASCENDING);
+	ret = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (model), &iter);
+	g_assert (ret);
+	gtk_tree_model_get (GTK_TREE_MODEL (model), &iter,
+			    GPK_PACKAGE_MODEL_COLUMN_ID, &package_id, -1);
+	g_assert_cmpstr (package_id, ==, "alpha;1.0;x86_64;fedora");
+
+	/* new rows go in the right place */
+	package = pk_package_new ();
+	pk_package_set_id (package, "beta;1.0;x86_64;fedora", NULL);
+	gpk_package_model_add (model, package, 0);
+	g_object_unref (package);
+	gpk_package_model_sort_added (model);
+	ret = gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (model), &iter, NULL, 1);
+	g_assert (ret);
+	g_assert_cmpstr (pk_package_get_id (gpk_package_model_get_package (model, &iter)), ==,
+			 "beta;1.0;x86_64;fedora");
+
+	/* find by name, after rows have been moved around */
+	ret = gpk_package_model_find_name (model, "mid", &iter);
+	g_assert (ret);
+	g_assert_cmpstr (pk_package_get_id (gpk_package_model_get_package (model, &iter)), ==,
+			 "mid;1.0;x86_64;fedora");
+	ret = gpk_package_model_find_name (model, "missing", &iter);
+	g_assert (!ret);
+	ret = gpk_package_model_find_name (model, "beta", &iter);
+	g_assert (ret);
+	ret = gpk_package_model_find_id (model, "zed;1.0;x86_64;fedora", &iter);
+	g_assert (ret);
+	g_assert_cmpstr (pk_package_get_name (gpk_package_model_get_package (model, &iter)), ==, "zed");
+
+	/* state */
+	gpk_package_model_set_state (model, &iter, 5);
+	g_assert_cmpint (gpk_package_model_get_state (model, &iter), ==, 5);
+
+	/* the message goes after the packages */
+	gpk_package_model_add_message (model, "system-search", "hello");
+	g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (model), NULL), ==, 5);
+	ret = gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (model), &iter, NULL, 4);
+	g_assert (ret);
+	g_assert (gpk_package_model_get_package (model, &iter) == NULL);
+	gtk_tree_model_get (GTK_TREE_MODEL (model), &iter,
+			    GPK_PACKAGE_MODEL_COLUMN_TEXT, &text, -1);
+	g_assert_cmpstr (text, ==, "hello");
+
+	gpk_package_model_clear (model);
+	g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (model), NULL), ==, 0);
+	g_object_unref (model);
+}
+
+static void
+gpk_test_package_model_filter_add (GpkPackageModel *model, const gchar *package_id, PkInfoEnum info)
+{
+	g_autoptr(PkPackage) package = pk_package_new ();
+	pk_package_set_id (package, package_id, NULL);
+	pk_package_set_info (package, info);
+	gpk_package_model_add (model, package, 0);
+}
+
+static gboolean
+gpk_test_package_model_filter_cb (PkPackage *package, gpointer user_data)
+{
+	return g_strcmp0 (pk_package_get_id (package), user_data) != 0;
+}
+
+static void
+gpk_test_package_model_row_deleted_cb (GtkTreeModel *model, GtkTreePath *path, guint *deleted)
+{
+	(*deleted)++;
+}
+
+static void
+gpk_test_package_model_filter_func (void)
+{
+	g_autoptr(GpkPackageModel) model = NULL;
+	GtkTreeIter iter;
+	gboolean ret;
+	guint deleted = 0;
+	guint removed;
+
+	model = gpk_package_model_new ();
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (model),
+					      GPK_PACKAGE_MODEL_COLUMN_ID,
+					      GTK_SORT_ASCENDING);
+	gpk_test_package_model_filter_add (model, "foo;1.0-1;noarch;fedora", PK_INFO_ENUM_AVAILABLE);
+	gpk_test_package_model_filter_add (model, "foo;1.1-1;noarch;fedora", PK_INFO_ENUM_AVAILABLE);
+	gpk_test_package_model_filter_add (model, "foo;0.9-1;noarch;installed", PK_INFO_ENUM_INSTALLED);
+	gpk_test_package_model_filter_add (model, "foo;1.1-1;nonesuch;fedora", PK_INFO_ENUM_AVAILABLE);
+	gpk_test_package_model_filter_add (model, "bar;2.0-1;noarch;fedora", PK_INFO_ENUM_AVAILABLE);
+	gpk_package_model_sort_added (model);
+	g_assert_cmpint (gpk_package_model_get_size (model), ==, 5);
+
+	/* only the newest available version of each, and what is installed */
+	ret = gpk_package_model_set_filters (model, pk_bitfield_value (PK_FILTER_ENUM_NEWEST));
+	g_assert (ret);
+	g_assert_cmpint (gpk_package_model_get_size (model), ==, 4);
+	g_assert (!gpk_package_model_find_id (model, "foo;1.0-1;noarch;fedora", &iter));
+	g_assert (gpk_package_model_find_name (model, "foo", &iter));
+	ret = gpk_package_model_set_filters (model, pk_bitfield_value (PK_FILTER_ENUM_NEWEST));
+	g_assert (!ret);
+
+	/* and only for this machine, which only removes that row */
+	g_signal_connect (model, "row-deleted",
+			  G_CALLBACK (gpk_test_package_model_row_deleted_cb), &deleted);
+	gpk_package_model_set_filters (model, pk_bitfield_from_enums (PK_FILTER_ENUM_NEWEST,
+								      PK_FILTER_ENUM_ARCH, -1));
+	g_assert_cmpint (gpk_package_model_get_size (model), ==, 3);
+	g_assert_cmpint (deleted, ==, 1);
+	g_assert (!gpk_package_model_find_id (model, "foo;1.1-1;nonesuch;fedora", &iter));
+
+	/* the rows are still in order */
+	ret = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (model), &iter);
+	g_assert (ret);
+	g_assert_cmpstr (pk_package_get_id (gpk_package_model_get_package (model, &iter)), ==,
+			 "bar;2.0-1;noarch;fedora");
+
+	/* a newer version hides the one that was shown */
+	gpk_test_package_model_filter_add (model, "foo;1.2-1;noarch;fedora", PK_INFO_ENUM_AVAILABLE);
+	g_assert_cmpint (gpk_package_model_get_size (model), ==, 3);
+	g_assert (!gpk_package_model_find_id (model, "foo;1.1-1;noarch;fedora", &iter));
+	g_assert (gpk_package_model_find_id (model, "foo;1.2-1;noarch;fedora", &iter));
+
+	/* everything comes back */
+	gpk_package_model_set_filters (model, 0);
+	g_assert_cmpint (gpk_package_model_get_size (model), ==, 6);
+	g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (model), NULL), ==, 6);
+
+	/* removing the newest version shows the one before it */
+	gpk_package_model_set_filters (model, pk_bitfield_value (PK_FILTER_ENUM_NEWEST));
+	removed = gpk_package_model_filter (model, gpk_test_package_model_filter_cb,
+					    (gpointer) "foo;1.2-1;noarch;fedora");
+	g_assert_cmpint (removed, ==, 1);
+	g_assert_cmpint (gpk_package_model_get_size (model), ==, 4);
+	g_assert (gpk_package_model_find_id (model, "foo;1.1-1;noarch;fedora", &iter));
+}
+
+static void
+gpk_test_package_model_rank_func (void)
+{
+	g_autoptr(GpkPackageModel) model = NULL;
+	g_autoptr(PkPackage) package1 = NULL;
+	g_autoptr(PkPackage) package2 = NULL;
+	g_autoptr(PkPackage) package3 = NULL;
+	GtkTreeIter iter;
+	gboolean ret;
+
+	model = gpk_package_model_new ();
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (model),
+					      GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID,
+					      GTK_SORT_ASCENDING);
+	package1 = pk_package_new ();
+	pk_package_set_id (package1, "aardvark;1.0-1;noarch;fedora", NULL);
+	package2 = pk_package_new ();
+	pk_package_set_id (package2, "zebra;1.0-1;noarch;fedora", NULL);
+	gpk_package_model_add_ranked (model, package1, 0, 1);
+	gpk_package_model_add_ranked (model, package2, 0, 0);
+	gpk_package_model_sort_added (model);
+
+	/* the default sort puts the better rank first */
+	ret = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (model), &iter);
+	g_assert (ret);
+	g_assert (gpk_package_model_get_package (model, &iter) == package2);
+
+	/* a column the user picked ignores the rank, both ways */
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (model),
+					      GPK_PACKAGE_MODEL_COLUMN_TEXT,
+					      GTK_SORT_ASCENDING);
+	ret = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (model), &iter);
+	g_assert (ret);
+	g_assert (gpk_package_model_get_package (model, &iter) == package1);
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (model),
+					      GPK_PACKAGE_MODEL_COLUMN_TEXT,
+					      GTK_SORT_DESCENDING);
+	ret = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (model), &iter);
+	g_assert (ret);
+	g_assert (gpk_package_model_get_package (model, &iter) == package2);
+
+	/* newer data for a row replaces it in place */
+	package3 = pk_package_new ();
+	pk_package_set_id (package3, "zebra;1.0-1;noarch;fedora", NULL);
+	g_object_set (package3, "summary", "Striped", NULL);
+	ret = gpk_package_model_update (model, package3, 0);
+	g_assert (ret);
+	g_assert_cmpint (gpk_package_model_get_size (model), ==, 2);
+	ret = gpk_package_model_find_id (model, "zebra;1.0-1;noarch;fedora", &iter);
+	g_assert (ret);
+	g_assert (gpk_package_model_get_package (model, &iter) == package3);
+
+	/* and going back to the default uses the rank again */
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (model),
+					      GPK_PACKAGE_MODEL_COLUMN_TEXT,
+					      GTK_SORT_ASCENDING);
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (model),
+					      GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID,
+					      GTK_SORT_ASCENDING);
+	ret = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (model), &iter);
+	g_assert (ret);
+	g_assert (gpk_package_model_get_package (model, &iter) == package3);
+}
+
+static void
+gpk_test_catalog_set_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	GMainLoop *loop = (GMainLoop *) user_data;
+	g_autoptr(GError) error = NULL;
+	gboolean ret;
+
+	ret = gpk_catalog_set_finish (GPK_CATALOG (source), res, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	g_main_loop_quit (loop);
+}
+
+static void
+gpk_test_catalog_func (void)
+{
+	g_autoptr(GpkCatalog) catalog = NULL;
+	g_autoptr(GpkCatalog) catalog2 = NULL;
+	g_autoptr(GPtrArray) array = NULL;
+	g_autoptr(GPtrArray) packages = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar *filename = NULL;
+	g_autofree gchar *tmpdir = NULL;
+	GMainLoop *loop;
+	PkPackage *package;
+	gboolean ret;
+
+	tmpdir = g_dir_make_tmp ("gpk-self-test-XXXXXX", &error);
+	g_assert_no_error (error);
+	filename = g_build_filename (tmpdir, "gpk-self-test.catalog", NULL);
+	catalog = gpk_catalog_new (filename);
+	ret = gpk_catalog_load (catalog, &error);
+	g_assert (!ret);
+	g_clear_error (&error);
+	g_assert (gpk_catalog_lookup (catalog, "group") == NULL);
+
+	packages = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	package = pk_package_new ();
+	pk_package_set_id (package, "foo;1.0-1;noarch;fedora", NULL);
+	g_object_set (package, "info", PK_INFO_ENUM_AVAILABLE, "summary", "The foo", NULL);
+	g_ptr_array_add (packages, package);
+	package = pk_package_new ();
+	pk_package_set_id (package, "bar;2.0-1;noarch;installed", NULL);
+	g_object_set (package, "info", PK_INFO_ENUM_INSTALLED, "summary", "The bar", NULL);
+	g_ptr_array_add (packages, package);
+	ret = gpk_catalog_set (catalog, "group", packages, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	g_ptr_array_set_size (packages, 1);
+	ret = gpk_catalog_set (catalog, "other", packages, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+
+	/* both lists are in the file */
+	catalog2 = gpk_catalog_new (filename);
+	ret = gpk_catalog_load (catalog2, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	array = gpk_catalog_lookup (catalog2, "group");
+	g_assert (array != NULL);
+	g_assert_cmpint (array->len, ==, 2);
+	package = g_ptr_array_index (array, 1);
+	g_assert_cmpstr (pk_package_get_id (package), ==, "bar;2.0-1;noarch;installed");
+	g_assert_cmpstr (pk_package_get_summary (package), ==, "The bar");
+	g_assert_cmpint (pk_package_get_info (package), ==, PK_INFO_ENUM_INSTALLED);
+	g_ptr_array_unref (array);
+	array = gpk_catalog_lookup (catalog2, "other");
+	g_assert (array != NULL);
+	g_assert_cmpint (array->len, ==, 1);
+	g_ptr_array_unref (array);
+
+	/* written in a thread, then mapped again */
+	loop = g_main_loop_new (NULL, FALSE);
+	gpk_catalog_set_async (catalog, "group", packages, NULL, gpk_test_catalog_set_cb, loop);
+	g_main_loop_run (loop);
+	g_main_loop_unref (loop);
+	array = gpk_catalog_lookup (catalog, "group");
+	g_assert (array != NULL);
+	g_assert_cmpint (array->len, ==, 1);
+	g_unlink (filename);
+	g_rmdir (tmpdir);
+}
+
+static void
+gpk_test_trigram_index_func (void)
+{
+	g_autoptr(GpkTrigramIndex) index = NULL;
+	gchar *word;
+
+	index = gpk_trigram_index_new ();
+	gpk_trigram_index_add (index, "python3-gobject");
+	gpk_trigram_index_add (index, "Python bindings for GObject Introspection.");
+	gpk_trigram_index_add (index, "gnome-packagekit");
+	g_assert_cmpint (gpk_trigram_index_get_size (index), ==, 10);
+
+	/* a transposition */
+	word = gpk_trigram_index_suggest (index, "pyhton");
+	g_assert_cmpstr (word, ==, "python");
+	g_free (word);
+
+	/* part of a name */
+	word = gpk_trigram_index_suggest (index, "pakagekit");
+	g_assert_cmpstr (word, ==, "packagekit");
+	g_free (word);
+
+	/* already right, too short, or nothing close */
+	g_assert (gpk_trigram_index_suggest (index, "GObject") == NULL);
+	g_assert (gpk_trigram_index_suggest (index, "py") == NULL);
+	g_assert (gpk_trigram_index_suggest (index, "firefox") == NULL);
+}
+
+static void
+gpk_test_file_model_sort_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	GMainLoop *loop = (GMainLoop *) user_data;
+	g_autoptr(GError) error = NULL;
+	gboolean ret;
+
+	ret = gpk_file_model_sort_finish (GPK_FILE_MODEL (source), res, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	g_main_loop_quit (loop);
+}
+
+static void
+gpk_test_file_model_func (void)
+{
+	GpkFileModel *model;
+	GtkTreeIter iter;
+	GMainLoop *loop;
+	gboolean ret;
+	const gchar *files[] = { "/usr/bin/zed",
+				 "/usr/share/doc/zed/README",
+				 "/usr/bin/alpha",
+				 "/usr/lib/libzed.so",
+				 NULL };
+	g_autofree gchar *filename = NULL;
+
+	model = gpk_file_model_new (g_strdupv ((gchar **) files));
+	g_assert_cmpint (gpk_file_model_get_size (model), ==, 4);
+
+	/* substring filter, then narrowed */
+	gpk_file_model_set_filter (model, "bin");
+	g_assert_cmpint (gpk_file_model_get_size (model), ==, 2);
+	gpk_file_model_set_filter (model, "bin/z");
+	g_assert_cmpint (gpk_file_model_get_size (model), ==, 1);
+	gpk_file_model_set_filter (model, "zed");
+	g_assert_cmpint (gpk_file_model_get_size (model), ==, 3);
+
+	/* sorted in a thread, keeping the filter */
+	loop = g_main_loop_new (NULL, FALSE);
+	gpk_file_model_sort_async (model, NULL, gpk_test_file_model_sort_cb, loop);
+	g_main_loop_run (loop);
+	g_main_loop_unref (loop);
+	g_assert_cmpint (gpk_file_model_get_size (model), ==, 3);
+	ret = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (model), &iter);
+	g_assert (ret);
+	gtk_tree_model_get (GTK_TREE_MODEL (model), &iter,
+			    GPK_FILE_MODEL_COLUMN_FILENAME, &filename, -1);
+	g_assert_cmpstr (filename, ==, "/usr/bin/zed");
+
+	/* everything again */
+	gpk_file_model_set_filter (model, "");
+	g_assert_cmpint (gpk_file_model_get_size (model), ==, 4);
+	g_object_unref (model);
+}
+
+/* the sort of names and summaries a search for "python3 gtk" returns */
+static const gchar *gpk_test_results_words[] = {
+	"python3", "gtk", "devel", "libs", "doc", "tests", "qt5",
+	"numpy", "requests", "xml", "perl", "ruby", NULL };
+
+static GPtrArray *
+gpk_test_results_packages (guint rows)
+{
+	GPtrArray *packages;
+	guint i;
+	guint n_words;
+
+	/* the packages already exist in the PkResults, so don't time them */
+	n_words = g_strv_length ((gchar **) gpk_test_results_words);
+	packages = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (i = 0; i < rows; i++) {
+		PkPackage *package;
+		PkInfoEnum info = PK_INFO_ENUM_AVAILABLE;
+		g_autofree gchar *package_id = NULL;
+		g_autofree gchar *summary = NULL;
+		package_id = g_strdup_printf ("%s-%s%u;1.0.%u;x86_64;fedora",
+					      gpk_test_results_words[i % n_words],
+					      gpk_test_results_words[(i / n_words) % n_words],
+					      i, i % 7);
+		summary = g_strdup_printf ("The %s bindings for %s",
+					   gpk_test_results_words[(i / 3) % n_words],
+					   gpk_test_results_words[(i / 7) % n_words]);
+		if (i % 5 == 0)
+			info = PK_INFO_ENUM_INSTALLED;
+		package = pk_package_new ();
+		pk_package_set_id (package, package_id, NULL);
+		g_object_set (package, "info", info, "summary", summary, NULL);
+		g_ptr_array_add (packages, package);
+	}
+	return packages;
+}
+
+static void
+gpk_test_results_flush (void)
+{
+	while (gtk_events_pending ())
+		gtk_main_iteration ();
+}
+
+/* ranks the results and adds them to a shown view like a search does,
+ * where a budget of 0 adds everything in one batch */
+static gdouble
+gpk_test_results_model (GPtrArray *packages, guint budget, guint *batches)
+{
+	GArray *ranked;
+	GTimer *timer;
+	GpkPackageModel *model;
+	GtkCellRenderer *renderer;
+	GtkTreeViewColumn *column;
+	GtkWidget *scroll;
+	GtkWidget *treeview;
+	GtkWidget *window;
+	gdouble elapsed;
+	g_auto(GStrv) terms = NULL;
+
+	model = gpk_package_model_new ();
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (model),
+					      GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID,
+					      GTK_SORT_ASCENDING);
+	treeview = gtk_tree_view_new_with_model (GTK_TREE_MODEL (model));
+	renderer = gtk_cell_renderer_text_new ();
+	column = gtk_tree_view_column_new_with_attributes ("Name", renderer,
+							   "markup", GPK_PACKAGE_MODEL_COLUMN_TEXT, NULL);
+	gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
+	scroll = gtk_scrolled_window_new (NULL, NULL);
+	gtk_container_add (GTK_CONTAINER (scroll), treeview);
+	window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+	gtk_window_set_default_size (GTK_WINDOW (window), 600, 400);
+	gtk_container_add (GTK_CONTAINER (window), scroll);
+	gtk_widget_show_all (window);
+	gpk_test_results_flush ();
+
+	/* each batch is one idle callback, with the redraws in between */
+	terms = g_strsplit ("python3 gtk", " ", -1);
+	timer = g_timer_new ();
+	ranked = gpk_results_rank (packages, terms);
+	for (*batches = 0; ranked->len > 0; (*batches)++) {
+		gpk_results_add (model, ranked, budget, NULL, NULL);
+		gpk_test_results_flush ();
+	}
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (model), NULL), ==, packages->len);
+
+	g_timer_destroy (timer);
+	g_array_unref (ranked);
+	gtk_widget_destroy (window);
+	g_object_unref (model);
+	return elapsed;
+}
+
+static void
+gpk_test_results_perf_func (void)
+{
+	guint sizes[] = { 10000, 50000, 100000 };
+	gdouble elapsed;
+	guint batches;
+	guint i;
+
+	if (!g_test_perf ()) {
+		g_test_skip ("only run with -m perf");
+		return;
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+		g_autoptr(GPtrArray) packages = NULL;
+		packages = gpk_test_results_packages (sizes[i]);
+
+		/* what a search did before the rows were added in batches */
+		elapsed = gpk_test_results_model (packages, 0, &batches);
+		g_test_message ("single batch: %u rows in %.2fs, %.0f rows/s",
+				sizes[i], elapsed, sizes[i] / elapsed);
+
+		elapsed = gpk_test_results_model (packages, GPK_RESULTS_BUDGET, &batches);
+		g_test_message ("%ums batches: %u rows in %u batches, %.2fs, %.0f rows/s",
+				GPK_RESULTS_BUDGET, sizes[i], batches, elapsed, sizes[i] / elapsed);
+		g_test_maximized_result (sizes[i] / elapsed,
+					 "%u rows, rows/s", sizes[i]);
+	}
 }
 
 int
@@ -177,6 +727,13 @@ main (int argc, char **argv)
 
 	g_test_add_func ("/gnome-packagekit/enum", gpk_test_enum_func);
 	g_test_add_func ("/gnome-packagekit/common", gpk_test_common_func);
+	g_test_add_func ("/gnome-packagekit/package-model", gpk_test_package_model_func);
+	g_test_add_func ("/gnome-packagekit/package-model-filter", gpk_test_package_model_filter_func);
+	g_test_add_func ("/gnome-packagekit/package-model-rank", gpk_test_package_model_rank_func);
+	g_test_add_func ("/gnome-packagekit/trigram-index", gpk_test_trigram_index_func);
+	g_test_add_func ("/gnome-packagekit/catalog", gpk_test_catalog_func);
+	g_test_add_func ("/gnome-packagekit/file-model", gpk_test_file_model_func);
+	g_test_add_func ("/gnome-packagekit/results-perf", gpk_test_results_perf_func);
 
 	return g_test_run ();
 }
@@ -0,0 +1,395 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2007-2013 Richard Hughes <richard@hughsie.com>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+#include <packagekit-glib2/packagekit.h>
+
+#include "gpk-trigram-index.h"
+
+#define GPK_TRIGRAM_INDEX_MIN_WORD		3 /* bytes */
+#define GPK_TRIGRAM_INDEX_MIN_SIMILARITY	0.2f
+
+/*
+ * The words of the package names and summaries, with a list of the
+ * words that contain each trigram, so a misspelt word only has to be
+ * compared against the few words that share some of its trigrams.
+ *
+ * Words are padded as "  word " before being split, so the start of a
+ * word counts for more than the end, and each trigram is packed into
+ * the low three bytes of a guint32.
+ */
+struct _GpkTrigramIndex
+{
+	GObject			 parent_instance;
+	GPtrArray		*words;		/* lower case */
+	GHashTable		*word_ids;	/* word to id + 1, keys owned by words */
+	GArray			*sizes;		/* of guint, trigrams in each word */
+	GHashTable		*postings;	/* trigram to GArray of word ids */
+};
+
+G_DEFINE_TYPE (GpkTrigramIndex, gpk_trigram_index, G_TYPE_OBJECT)
+
+static GArray *
+gpk_trigram_index_get_trigrams (const gchar *word)
+{
+	GArray *trigrams = g_array_new (FALSE, FALSE, sizeof (guint32));
+	g_autofree gchar *padded = g_strdup_printf ("  %s ", word);
+	guint32 trigram;
+	guint i;
+	guint j;
+
+	for (i = 0; padded[i + 2] != '\0'; i++) {
+		trigram = (guint32) (guint8) padded[i] << 16 |
+			  (guint32) (guint8) padded[i + 1] << 8 |
+			  (guint32) (guint8) padded[i + 2];
+
+		/* each one only counts once */
+		for (j = 0; j < trigrams->len; j++) {
+			if (g_array_index (trigrams, guint32, j) == trigram)
+				break;
+		}
+		if (j == trigrams->len)
+			g_array_append_val (trigrams, trigram);
+	}
+	return trigrams;
+}
+
+static void
+gpk_trigram_index_add_word (GpkTrigramIndex *index, const gchar *word)
+{
+	GArray *ids;
+	guint32 trigram;
+	guint id;
+	guint i;
+	g_autoptr(GArray) trigrams = NULL;
+	g_auto(GStrv) parts = NULL;
+
+	if (strlen (word) < GPK_TRIGRAM_INDEX_MIN_WORD)
+		return;
+	if (g_hash_table_contains (index->word_ids, word))
+		return;
+
+	id = index->words->len;
+	g_ptr_array_add (index->words, g_strdup (word));
+	g_hash_table_insert (index->word_ids,
+			     g_ptr_array_index (index->words, id),
+			     GUINT_TO_POINTER (id + 1));
+	trigrams = gpk_trigram_index_get_trigrams (word);
+	g_array_append_val (index->sizes, trigrams->len);
+	for (i = 0; i < trigrams->len; i++) {
+		trigram = g_array_index (trigrams, guint32, i);
+		ids = g_hash_table_lookup (index->postings, GUINT_TO_POINTER (trigram));
+		if (ids == NULL) {
+			ids = g_array_new (FALSE, FALSE, sizeof (guint));
+			g_hash_table_insert (index->postings, GUINT_TO_POINTER (trigram), ids);
+		}
+		g_array_append_val (ids, id);
+	}
+
+	/* so "gnome-packagekit" can also suggest "packagekit" */
+	if (strpbrk (word, "-_.") == NULL)
+		return;
+	parts = g_strsplit_set (word, "-_.", -1);
+	for (i = 0; parts[i] != NULL; i++)
+		gpk_trigram_index_add_word (index, parts[i]);
+}
+
+/**
+ * gpk_trigram_index_add:
+ * @index: a #GpkTrigramIndex
+ * @text: a package name or summary
+ *
+ * Adds each word of the text that is not already known.
+ **/
+void
+gpk_trigram_index_add (GpkTrigramIndex *index, const gchar *text)
+{
+	const gchar *start = NULL;
+	const gchar *end;
+	const gchar *p;
+	g_autofree gchar *lower = NULL;
+
+	g_return_if_fail (GPK_IS_TRIGRAM_INDEX (index));
+
+	if (text == NULL)
+		return;
+	lower = g_utf8_strdown (text, -1);
+	for (p = lower; ; p++) {
+		if (*p != '\0' &&
+		    (g_ascii_isalnum (*p) || (guchar) *p >= 0x80 ||
+		     strchr ("-_.+", *p) != NULL)) {
+			if (start == NULL)
+				start = p;
+			continue;
+		}
+		if (start != NULL) {
+			g_autofree gchar *word = NULL;
+
+			/* not the punctuation at the end of a sentence */
+			end = p;
+			while (start < end && strchr ("-_.", *start) != NULL)
+				start++;
+			while (end > start && strchr ("-_.", end[-1]) != NULL)
+				end--;
+			word = g_strndup (start, end - start);
+			gpk_trigram_index_add_word (index, word);
+			start = NULL;
+		}
+		if (*p == '\0')
+			break;
+	}
+}
+
+/**
+ * gpk_trigram_index_get_size:
+ *
+ * Return value: the number of different words
+ **/
+guint
+gpk_trigram_index_get_size (GpkTrigramIndex *index)
+{
+	g_return_val_if_fail (GPK_IS_TRIGRAM_INDEX (index), 0);
+	return index->words->len;
+}
+
+/* optimal string alignment, so "pyhton" is only one away from "python" */
+static guint
+gpk_trigram_index_distance (const gchar *a, const gchar *b)
+{
+	guint len_a = strlen (a);
+	guint len_b = strlen (b);
+	guint cost;
+	guint i;
+	guint j;
+	guint *row;
+	guint *prev;
+	g_autofree guint *d = NULL;
+
+	d = g_new (guint, (len_a + 1) * (len_b + 1));
+	for (i = 0; i <= len_a; i++)
+		d[i * (len_b + 1)] = i;
+	for (j = 0; j <= len_b; j++)
+		d[j] = j;
+	for (i = 1; i <= len_a; i++) {
+		row = d + i * (len_b + 1);
+		prev = row - (len_b + 1);
+		for (j = 1; j <= len_b; j++) {
+			cost = a[i - 1] == b[j - 1] ? 0 : 1;
+			row[j] = MIN (MIN (row[j - 1] + 1, prev[j] + 1),
+				      prev[j - 1] + cost);
+			if (i > 1 && j > 1 &&
+			    a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1])
+				row[j] = MIN (row[j], (prev - (len_b + 1))[j - 2] + 1);
+		}
+	}
+	return d[len_a * (len_b + 1) + len_b];
+}
+
+/**
+ * gpk_trigram_index_suggest:
+ * @index: a #GpkTrigramIndex
+ * @word: a single search term
+ *
+ * Finds the known word that is closest to a misspelt one.
+ *
+ * Return value: the word to use instead, or %NULL if @word is known or
+ * there is nothing close enough
+ **/
+gchar *
+gpk_trigram_index_suggest (GpkTrigramIndex *index, const gchar *word)
+{
+	GArray *ids;
+	GHashTableIter iter;
+	const gchar *best = NULL;
+	const gchar *candidate;
+	gdouble best_similarity = 0.f;
+	gdouble similarity;
+	gpointer key;
+	gpointer value;
+	guint best_distance = G_MAXUINT;
+	guint count;
+	guint distance;
+	guint id;
+	guint len;
+	guint max_distance;
+	guint i;
+	guint j;
+	g_autofree gchar *lower = NULL;
+	g_autoptr(GArray) trigrams = NULL;
+	g_autoptr(GHashTable) shared = NULL;
+
+	g_return_val_if_fail (GPK_IS_TRIGRAM_INDEX (index), NULL);
+	g_return_val_if_fail (word != NULL, NULL);
+
+	lower = g_utf8_strdown (word, -1);
+	len = strlen (lower);
+	if (len < GPK_TRIGRAM_INDEX_MIN_WORD)
+		return NULL;
+
+	/* spelled correctly */
+	if (g_hash_table_contains (index->word_ids, lower))
+		return NULL;
+
+	/* how many trigrams each word has in common with this one */
+	trigrams = gpk_trigram_index_get_trigrams (lower);
+	shared = g_hash_table_new (g_direct_hash, g_direct_equal);
+	for (i = 0; i < trigrams->len; i++) {
+		ids = g_hash_table_lookup (index->postings,
+					   GUINT_TO_POINTER (g_array_index (trigrams, guint32, i)));
+		if (ids == NULL)
+			continue;
+		for (j = 0; j < ids->len; j++) {
+			key = GUINT_TO_POINTER (g_array_index (ids, guint, j));
+			count = GPOINTER_TO_UINT (g_hash_table_lookup (shared, key));
+			g_hash_table_insert (shared, key, GUINT_TO_POINTER (count + 1));
+		}
+	}
+
+	/* only work out the distance for the words that look alike */
+	max_distance = len <= 4 ? 1 : 2;
+	g_hash_table_iter_init (&iter, shared);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		id = GPOINTER_TO_UINT (key);
+		count = GPOINTER_TO_UINT (value);
+		similarity = (gdouble) count /
+			     (trigrams->len + g_array_index (index->sizes, guint, id) - count);
+		if (similarity < GPK_TRIGRAM_INDEX_MIN_SIMILARITY)
+			continue;
+		candidate = g_ptr_array_index (index->words, id);
+		if ((guint) ABS ((gint) strlen (candidate) - (gint) len) > max_distance)
+			continue;
+		distance = gpk_trigram_index_distance (lower, candidate);
+		if (distance > max_distance)
+			continue;
+		if (distance < best_distance ||
+		    (distance == best_distance && similarity > best_similarity) ||
+		    (distance == best_distance && similarity == best_similarity &&
+		     g_strcmp0 (candidate, best) < 0)) {
+			best = candidate;
+			best_distance = distance;
+			best_similarity = similarity;
+		}
+	}
+	return g_strdup (best);
+}
+
+static void
+gpk_trigram_index_new_thread_cb (GTask *task,
+				 gpointer source_object,
+				 gpointer task_data,
+				 GCancellable *cancellable)
+{
+	GPtrArray *packages = task_data;
+	GpkTrigramIndex *index;
+	PkPackage *package;
+	guint i;
+
+	index = gpk_trigram_index_new ();
+	for (i = 0; i < packages->len; i++) {
+		package = g_ptr_array_index (packages, i);
+		gpk_trigram_index_add (index, pk_package_get_name (package));
+		gpk_trigram_index_add (index, pk_package_get_summary (package));
+	}
+	if (g_task_return_error_if_cancelled (task)) {
+		g_object_unref (index);
+		return;
+	}
+	g_task_return_pointer (task, index, g_object_unref);
+}
+
+/**
+ * gpk_trigram_index_new_async:
+ * @packages: an array of #PkPackage, which is not changed
+ *
+ * Indexes the names and summaries of the packages in a thread.
+ **/
+void
+gpk_trigram_index_new_async (GPtrArray *packages,
+			     GCancellable *cancellable,
+			     GAsyncReadyCallback callback,
+			     gpointer user_data)
+{
+	g_autoptr(GTask) task = NULL;
+
+	g_return_if_fail (packages != NULL);
+
+	task = g_task_new (NULL, cancellable, callback, user_data);
+	g_task_set_source_tag (task, gpk_trigram_index_new_async);
+	g_task_set_task_data (task, g_ptr_array_ref (packages),
+			      (GDestroyNotify) g_ptr_array_unref);
+	g_task_run_in_thread (task, gpk_trigram_index_new_thread_cb);
+}
+
+/**
+ * gpk_trigram_index_new_finish:
+ *
+ * Return value: the new #GpkTrigramIndex, or %NULL for an error
+ **/
+GpkTrigramIndex *
+gpk_trigram_index_new_finish (GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail (g_task_is_valid (res, NULL), NULL);
+	return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+static void
+gpk_trigram_index_finalize (GObject *object)
+{
+	GpkTrigramIndex *index = GPK_TRIGRAM_INDEX (object);
+
+	g_hash_table_unref (index->word_ids);
+	g_ptr_array_unref (index->words);
+	g_array_unref (index->sizes);
+	g_hash_table_unref (index->postings);
+
+	G_OBJECT_CLASS (gpk_trigram_index_parent_class)->finalize (object);
+}
+
+static void
+gpk_trigram_index_class_init (GpkTrigramIndexClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (class);
+	object_class->finalize = gpk_trigram_index_finalize;
+}
+
+static void
+gpk_trigram_index_init (GpkTrigramIndex *index)
+{
+	index->words = g_ptr_array_new_with_free_func (g_free);
+	index->word_ids = g_hash_table_new (g_str_hash, g_str_equal);
+	index->sizes = g_array_new (FALSE, FALSE, sizeof (guint));
+	index->postings = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+						 NULL, (GDestroyNotify) g_array_unref);
+}
+
+/**
+ * gpk_trigram_index_new:
+ *
+ * Return value: a new empty #GpkTrigramIndex
+ **/
+GpkTrigramIndex *
+gpk_trigram_index_new (void)
+{
+	return g_object_new (GPK_TYPE_TRIGRAM_INDEX, NULL);
+}
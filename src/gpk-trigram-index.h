@@ -0,0 +1,48 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2007-2013 Richard Hughes <richard@hughsie.com>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef GPK_TRIGRAM_INDEX_H
+#define GPK_TRIGRAM_INDEX_H
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GPK_TYPE_TRIGRAM_INDEX (gpk_trigram_index_get_type())
+G_DECLARE_FINAL_TYPE (GpkTrigramIndex, gpk_trigram_index, GPK, TRIGRAM_INDEX, GObject)
+
+GpkTrigramIndex	*gpk_trigram_index_new			(void);
+void		 gpk_trigram_index_add			(GpkTrigramIndex	*index,
+							 const gchar		*text);
+guint		 gpk_trigram_index_get_size		(GpkTrigramIndex	*index);
+gchar		*gpk_trigram_index_suggest		(GpkTrigramIndex	*index,
+							 const gchar		*word);
+void		 gpk_trigram_index_new_async		(GPtrArray		*packages,
+							 GCancellable		*cancellable,
+							 GAsyncReadyCallback	 callback,
+							 gpointer		 user_data);
+GpkTrigramIndex	*gpk_trigram_index_new_finish		(GAsyncResult		*res,
+							 GError			**error);
+
+G_END_DECLS
+
+#endif /* GPK_TRIGRAM_INDEX_H */
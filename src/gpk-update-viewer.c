@@ -28,6 +28,7 @@
 #include <gtk/gtk.h>
 #include <locale.h>
 #include <packagekit-glib2/packagekit.h>
+#include <string.h>
 
 #ifdef HAVE_SYSTEMD
 #include "systemd-proxy.h"
@@ -50,9 +51,10 @@
 static	gboolean		 ignore_updates_changed = FALSE;
 static	gchar			*package_id_last = NULL;
 static	guint			 auto_shutdown_id = 0;
-static	guint			 size_total = 0;
+static	guint64			 size_total = 0;
 static	guint			 number_total = 0;
 static	PkRestartEnum		 restart_worst = 0;
+static	guint			 restart_totals[PK_RESTART_ENUM_LAST];
 #ifdef HAVE_SYSTEMD
 static  SystemdProxy		*proxy = NULL;
 #endif
@@ -61,6 +63,17 @@ static	GSettings		*settings = NULL;
 static	GPtrArray		*update_array = NULL;
 static	GtkBuilder		*builder = NULL;
 static	GtkTreeStore		*array_store_updates = NULL;
+static	GHashTable		*package_id_rows = NULL;
+static	GtkTreeIter		 info_headers[PK_INFO_ENUM_LAST];
+static	gboolean		 info_headers_valid[PK_INFO_ENUM_LAST];
+static	gboolean		 scroll_active = TRUE;
+static	guint			 progress_tick_id = 0;
+static	GHashTable		*progress_items = NULL;
+static	gchar			*progress_scroll_id = NULL;
+static	PkStatusEnum		 progress_status = PK_STATUS_ENUM_UNKNOWN;
+static	gboolean		 progress_status_pending = FALSE;
+static	gint			 progress_percentage = -1;
+static	gboolean		 progress_percentage_pending = FALSE;
 static	GtkTextBuffer		*text_buffer = NULL;
 static	PkControl		*control = NULL;
 static	PkRestartEnum		 restart_update = 0;
@@ -86,12 +99,12 @@ enum {
 	GPK_UPDATES_COLUMN_STATUS,
 	GPK_UPDATES_COLUMN_DETAILS_OBJ,
 	GPK_UPDATES_COLUMN_UPDATE_DETAIL_OBJ,
-	GPK_UPDATES_COLUMN_PULSE,
 	GPK_UPDATES_COLUMN_VISIBLE,
 	GPK_UPDATES_COLUMN_LAST
 };
 
 static gboolean gpk_update_viewer_get_new_update_array (void);
+static void gpk_update_viewer_progress_sync (void);
 
 static gboolean
 _g_strzero (const gchar *text)
@@ -363,6 +376,7 @@ gpk_update_viewer_update_packages_cb (PkTask *_task, GAsyncResult *res, gpointer
 
 	/* get the results */
 	results = pk_task_generic_finish (task, res, &error);
+	gpk_update_viewer_progress_sync ();
 	if (results == NULL) {
 		/* not a PK error */
 		if (error->domain != PK_CLIENT_ERROR) {
@@ -489,144 +503,248 @@ out:
 	ignore_updates_changed = FALSE;
 }
 
-static GSList *active_rows = NULL;
-static guint active_row_timeout_id = 0;
+static void
+gpk_update_viewer_totals_reset (void)
+{
+	size_total = 0;
+	number_total = 0;
+	restart_worst = PK_RESTART_ENUM_NONE;
+	memset (restart_totals, 0, sizeof (restart_totals));
+}
 
-static gint
-gpk_update_viewer_compare_refs (GtkTreeRowReference *a, GtkTreeRowReference *b)
+static void
+gpk_update_viewer_totals_adjust (guint64 size, PkRestartEnum restart, gboolean add)
 {
-	GtkTreeModel *am, *bm;
-	GtkTreePath *ap, *bp;
-	gint res;
+	guint i;
 
-	am = gtk_tree_row_reference_get_model (a);
-	bm = gtk_tree_row_reference_get_model (b);
+	if (restart >= PK_RESTART_ENUM_LAST)
+		restart = PK_RESTART_ENUM_UNKNOWN;
+	if (add) {
+		size_total += size;
+		number_total++;
+		restart_totals[restart]++;
+	} else {
+		size_total -= size;
+		number_total--;
+		restart_totals[restart]--;
+	}
 
-	res = 1;
-	if (am == bm) {
-		ap = gtk_tree_row_reference_get_path (a);
-		bp = gtk_tree_row_reference_get_path (b);
+	/* the worst restart is the highest kind still selected */
+	restart_worst = PK_RESTART_ENUM_NONE;
+	for (i = PK_RESTART_ENUM_LAST - 1; i > PK_RESTART_ENUM_NONE; i--) {
+		if (restart_totals[i] > 0) {
+			restart_worst = i;
+			break;
+		}
+	}
+}
+
+static void
+gpk_update_viewer_set_selected (GtkTreeIter *iter, gboolean selected)
+{
+	gboolean selected_old;
+	guint64 size;
+	PkRestartEnum restart;
+	g_autofree gchar *package_id = NULL;
 
-		res = gtk_tree_path_compare (ap, bp);
+	gtk_tree_model_get (GTK_TREE_MODEL (array_store_updates), iter,
+			    GPK_UPDATES_COLUMN_SELECT, &selected_old,
+			    GPK_UPDATES_COLUMN_RESTART, &restart,
+			    GPK_UPDATES_COLUMN_SIZE, &size,
+			    GPK_UPDATES_COLUMN_ID, &package_id,
+			    -1);
+	if (package_id != NULL && selected_old != selected)
+		gpk_update_viewer_totals_adjust (size, restart, selected);
+	gtk_tree_store_set (array_store_updates, iter,
+			    GPK_UPDATES_COLUMN_SELECT, selected,
+			    -1);
+}
 
-		gtk_tree_path_free (ap);
-		gtk_tree_path_free (bp);
-	}
+static void
+gpk_update_viewer_set_size (GtkTreeIter *iter, guint64 size)
+{
+	gboolean selected;
+	guint64 size_old;
 
-	return res;
+	gtk_tree_model_get (GTK_TREE_MODEL (array_store_updates), iter,
+			    GPK_UPDATES_COLUMN_SELECT, &selected,
+			    GPK_UPDATES_COLUMN_SIZE, &size_old,
+			    -1);
+	if (selected)
+		size_total = size_total - size_old + size;
+	gtk_tree_store_set (array_store_updates, iter,
+			    GPK_UPDATES_COLUMN_SIZE, size,
+			    GPK_UPDATES_COLUMN_SIZE_DISPLAY, (guint) MIN (size, G_MAXUINT),
+			    -1);
 }
 
-static gboolean
-gpk_update_viewer_pulse_active_rows (void)
+static void
+gpk_update_viewer_set_restart (GtkTreeIter *iter, PkRestartEnum restart)
 {
-	GSList *l;
-	GtkTreeRowReference *ref;
-	GtkTreeModel *model;
-	GtkTreePath *path;
-	GtkTreeIter iter;
-	gint val;
+	gboolean selected;
+	PkRestartEnum restart_old;
 
-	for (l = active_rows; l; l = l->next) {
-		ref = l->data;
-		model = gtk_tree_row_reference_get_model (ref);
-		path = gtk_tree_row_reference_get_path (ref);
-		if (path) {
-			gtk_tree_model_get_iter (model, &iter, path);
-			gtk_tree_model_get (model, &iter, GPK_UPDATES_COLUMN_PULSE, &val, -1);
-			gtk_tree_store_set (GTK_TREE_STORE(model), &iter, GPK_UPDATES_COLUMN_PULSE, val + 1, -1);
-			gtk_tree_path_free (path);
-		}
+	gtk_tree_model_get (GTK_TREE_MODEL (array_store_updates), iter,
+			    GPK_UPDATES_COLUMN_SELECT, &selected,
+			    GPK_UPDATES_COLUMN_RESTART, &restart_old,
+			    -1);
+	if (selected) {
+		gpk_update_viewer_totals_adjust (0, restart_old, FALSE);
+		gpk_update_viewer_totals_adjust (0, restart, TRUE);
 	}
+	gtk_tree_store_set (array_store_updates, iter,
+			    GPK_UPDATES_COLUMN_RESTART, restart,
+			    -1);
+}
 
-	return TRUE;
+static GtkTreePath *
+gpk_update_viewer_model_get_path (GtkTreeModel *model, const gchar *package_id)
+{
+	GtkTreeRowReference *row;
+	g_return_val_if_fail (package_id != NULL, NULL);
+
+	/* rows are indexed as they are added, so this is O(1) */
+	row = g_hash_table_lookup (package_id_rows, package_id);
+	if (row == NULL || !gtk_tree_row_reference_valid (row))
+		return NULL;
+	return gtk_tree_row_reference_get_path (row);
+}
+
+static GHashTable *active_rows = NULL;
+static guint active_row_tick_id = 0;
+static guint active_row_pulse = 0;
+
+static void
+gpk_update_viewer_active_row_data_func (GtkTreeViewColumn *column,
+					 GtkCellRenderer *renderer,
+					 GtkTreeModel *model,
+					 GtkTreeIter *iter,
+					 gpointer user_data)
+{
+	g_autofree gchar *package_id = NULL;
+	gint pulse = -1;
+
+	gtk_tree_model_get (model, iter,
+			    GPK_UPDATES_COLUMN_ID, &package_id,
+			    -1);
+	if (package_id != NULL && g_hash_table_contains (active_rows, package_id))
+		pulse = active_row_pulse;
+	g_object_set (renderer, "pulse", pulse, NULL);
+}
+
+static gboolean
+gpk_update_viewer_pulse_active_rows (GtkWidget *widget,
+				     GdkFrameClock *frame_clock,
+				     gpointer user_data)
+{
+	GHashTableIter hash_iter;
+	GtkTreeIter iter;
+	GtkTreeModel *model;
+	GtkTreePath *end = NULL;
+	GtkTreePath *start = NULL;
+	gpointer key;
+	guint pulse;
+
+	/* advance once every 60ms of frame time */
+	pulse = gdk_frame_clock_get_frame_time (frame_clock) / 60000;
+	if (pulse == active_row_pulse)
+		return G_SOURCE_CONTINUE;
+	active_row_pulse = pulse;
+
+	/* only redraw the spinners that are actually on screen */
+	if (!gtk_tree_view_get_visible_range (GTK_TREE_VIEW (widget), &start, &end))
+		return G_SOURCE_CONTINUE;
+	model = gtk_tree_view_get_model (GTK_TREE_VIEW (widget));
+	g_hash_table_iter_init (&hash_iter, active_rows);
+	while (g_hash_table_iter_next (&hash_iter, &key, NULL)) {
+		g_autoptr(GtkTreePath) path = NULL;
+		path = gpk_update_viewer_model_get_path (model, key);
+		if (path == NULL)
+			continue;
+		if (gtk_tree_path_compare (path, start) < 0 ||
+		    gtk_tree_path_compare (path, end) > 0)
+			continue;
+		if (gtk_tree_model_get_iter (model, &iter, path))
+			gtk_tree_model_row_changed (model, path, &iter);
+	}
+	gtk_tree_path_free (start);
+	gtk_tree_path_free (end);
+	return G_SOURCE_CONTINUE;
 }
 
 static void
-gpk_update_viewer_add_active_row (GtkTreeModel *model, GtkTreePath *path)
+gpk_update_viewer_add_active_row (const gchar *package_id)
 {
-	GtkTreeRowReference *ref;
-	GSList *row = NULL;
+	GtkWidget *widget;
 
 	/* check if already active */
-	ref = gtk_tree_row_reference_new (model, path);
-	if (ref == NULL)
-		return;
-	row = g_slist_find_custom (active_rows, (gconstpointer)ref, (GCompareFunc)gpk_update_viewer_compare_refs);
-	if (row != NULL) {
+	if (!g_hash_table_add (active_rows, g_strdup (package_id))) {
 		g_debug ("already active");
-		gtk_tree_row_reference_free (ref);
 		return;
 	}
 
-	/* add poll */
-	if (active_row_timeout_id == 0) {
-		active_row_timeout_id = g_timeout_add (60, (GSourceFunc)gpk_update_viewer_pulse_active_rows, NULL);
-		g_source_set_name_by_id (active_row_timeout_id, "[GpkUpdateViewer] pulse row");
+	/* animate from the frame clock */
+	if (active_row_tick_id == 0) {
+		widget = GTK_WIDGET(gtk_builder_get_object (builder, "treeview_updates"));
+		active_row_tick_id = gtk_widget_add_tick_callback (widget,
+								   gpk_update_viewer_pulse_active_rows,
+								   NULL, NULL);
 	}
-	active_rows = g_slist_prepend (active_rows, ref);
 }
 
 static void
-gpk_update_viewer_remove_active_row (GtkTreeModel *model, GtkTreePath *path)
+gpk_update_viewer_stop_active_rows (void)
 {
-	GSList *row;
-	GtkTreeRowReference *ref;
-	GtkTreeIter iter;
+	GtkWidget *widget;
 
-	gtk_tree_model_get_iter (model, &iter, path);
-	gtk_tree_store_set (GTK_TREE_STORE(model), &iter, GPK_UPDATES_COLUMN_PULSE, -1, -1);
+	if (active_row_tick_id == 0)
+		return;
+	widget = GTK_WIDGET(gtk_builder_get_object (builder, "treeview_updates"));
+	gtk_widget_remove_tick_callback (widget, active_row_tick_id);
+	active_row_tick_id = 0;
+}
+
+static void
+gpk_update_viewer_remove_active_row (GtkTreeModel *model, const gchar *package_id)
+{
+	GtkTreeIter iter;
+	g_autoptr(GtkTreePath) path = NULL;
 
-	ref = gtk_tree_row_reference_new (model, path);
-	row = g_slist_find_custom (active_rows, (gconstpointer)ref, (GCompareFunc)gpk_update_viewer_compare_refs);
-	gtk_tree_row_reference_free (ref);
-	if (row == NULL) {
+	if (!g_hash_table_remove (active_rows, package_id)) {
 		g_warning ("row not already added");
 		return;
 	}
 
-	active_rows = g_slist_remove_link (active_rows, row);
-	gtk_tree_row_reference_free (row->data);
-	g_slist_free (row);
+	/* redraw the row without its spinner */
+	path = gpk_update_viewer_model_get_path (model, package_id);
+	if (path != NULL && gtk_tree_model_get_iter (model, &iter, path))
+		gtk_tree_model_row_changed (model, path, &iter);
 
-	if (active_rows == NULL) {
-		g_source_remove (active_row_timeout_id);
-		active_row_timeout_id = 0;
-	}
+	if (g_hash_table_size (active_rows) == 0)
+		gpk_update_viewer_stop_active_rows ();
 }
 
-static gboolean
-gpk_update_viewer_find_iter_model_cb (GtkTreeModel *model,
-				      GtkTreePath *path,
-				      GtkTreeIter *iter,
-				      const gchar *package_id)
+static void
+gpk_update_viewer_model_add_row (GtkTreeIter *iter, const gchar *package_id)
 {
-	g_autofree gchar *package_id_tmp = NULL;
-	GtkTreePath **_path = NULL;
-
-	gtk_tree_model_get (model, iter,
-			    GPK_UPDATES_COLUMN_ID, &package_id_tmp,
-			    -1);
-	if (package_id_tmp == NULL)
-		return FALSE;
+	g_autoptr(GtkTreePath) path = NULL;
 
-	/* match on the package id */
-	if (g_strcmp0 (package_id, package_id_tmp) == 0) {
-		_path = (GtkTreePath **) g_object_get_data (G_OBJECT(model), "_path");
-		*_path = gtk_tree_path_copy (path);
-		return TRUE;
-	}
-	return FALSE;
+	/* the reference follows the row when the store is sorted */
+	path = gtk_tree_model_get_path (GTK_TREE_MODEL (array_store_updates), iter);
+	g_hash_table_insert (package_id_rows,
+			     g_strdup (package_id),
+			     gtk_tree_row_reference_new (GTK_TREE_MODEL (array_store_updates), path));
 }
 
-static GtkTreePath *
-gpk_update_viewer_model_get_path (GtkTreeModel *model, const gchar *package_id)
+static void
+gpk_update_viewer_model_clear (void)
 {
-	GtkTreePath *path = NULL;
-	g_return_val_if_fail (package_id != NULL, NULL);
-	g_object_set_data (G_OBJECT(model), "_path", (gpointer) &path);
-	gtk_tree_model_foreach (model, (GtkTreeModelForeachFunc) gpk_update_viewer_find_iter_model_cb, (gpointer) package_id);
-	g_object_steal_data (G_OBJECT(model), "_path");
-	return path;
+	g_hash_table_remove_all (package_id_rows);
+	g_hash_table_remove_all (active_rows);
+	gpk_update_viewer_stop_active_rows ();
+	memset (info_headers_valid, 0, sizeof (info_headers_valid));
+	gpk_update_viewer_totals_reset ();
+	gtk_tree_store_clear (array_store_updates);
 }
 
 static const gchar *
@@ -668,20 +786,8 @@ gpk_update_view_get_info_headers (PkInfoEnum info)
 static void
 gpk_update_viewer_get_parent_for_info (PkInfoEnum info, GtkTreeIter *parent)
 {
-	gboolean is_package;
-	gboolean ret = FALSE;
-	gboolean valid;
 	g_autofree gchar *title = NULL;
 	GtkTreeIter iter;
-	GtkTreeModel *model;
-	GtkTreeView *treeview;
-	PkInfoEnum info_tmp;
-
-	treeview = GTK_TREE_VIEW(gtk_builder_get_object (builder, "treeview_updates"));
-	model = gtk_tree_view_get_model (treeview);
-
-	/* get the first iter in the array */
-	valid = gtk_tree_model_get_iter_first (model, &iter);
 
 	/* smush some update states together */
 	switch (info) {
@@ -692,47 +798,206 @@ gpk_update_viewer_get_parent_for_info (PkInfoEnum info, GtkTreeIter *parent)
 	default:
 		break;
 	}
+	if (info >= PK_INFO_ENUM_LAST)
+		info = PK_INFO_ENUM_UNKNOWN;
 
-	/* find out how many we should update */
-	while (valid) {
-		g_autofree gchar *package_id_tmp = NULL;
-		gtk_tree_model_get (model, &iter,
-				    GPK_UPDATES_COLUMN_INFO, &info_tmp,
-				    GPK_UPDATES_COLUMN_ID, &package_id_tmp,
-				    -1);
-		is_package = package_id_tmp != NULL;
+	/* tree store iters persist, so the header can be reused directly */
+	if (info_headers_valid[info]) {
+		*parent = info_headers[info];
+		return;
+	}
 
-		/* right section? */
-		if (!is_package && info_tmp == info) {
-			*parent = iter;
-			ret = TRUE;
-			break;
+	/* create */
+	title = g_strdup_printf ("<b>%s</b>",
+				 gpk_update_view_get_info_headers (info));
+	gtk_tree_store_append (array_store_updates, &iter, NULL);
+	gtk_tree_store_set (array_store_updates, &iter,
+			    GPK_UPDATES_COLUMN_TEXT, title,
+			    GPK_UPDATES_COLUMN_ID, NULL,
+			    GPK_UPDATES_COLUMN_INFO, info,
+			    GPK_UPDATES_COLUMN_SELECT, TRUE,
+			    GPK_UPDATES_COLUMN_VISIBLE, FALSE,
+			    GPK_UPDATES_COLUMN_CLICKABLE, FALSE,
+			    GPK_UPDATES_COLUMN_RESTART, PK_RESTART_ENUM_NONE,
+			    GPK_UPDATES_COLUMN_STATUS, PK_INFO_ENUM_UNKNOWN,
+			    GPK_UPDATES_COLUMN_SIZE, (guint64) 0,
+			    GPK_UPDATES_COLUMN_SIZE_DISPLAY, 0,
+			    GPK_UPDATES_COLUMN_PERCENTAGE, 0,
+			    -1);
+	info_headers[info] = iter;
+	info_headers_valid[info] = TRUE;
+	*parent = iter;
+}
+
+static void
+gpk_update_viewer_settings_changed_cb (GSettings *_settings, const gchar *key, gpointer user_data)
+{
+	if (g_strcmp0 (key, GPK_SETTINGS_SCROLL_ACTIVE) == 0)
+		scroll_active = g_settings_get_boolean (settings, GPK_SETTINGS_SCROLL_ACTIVE);
+}
+
+static void
+gpk_update_viewer_progress_flush_status (void)
+{
+	GdkWindow *window;
+	const gchar *title;
+	GdkDisplay *display;
+	GtkWidget *widget;
+	g_autoptr(GdkCursor) cursor = NULL;
+
+	/* use correct status pane */
+	widget = GTK_WIDGET(gtk_builder_get_object (builder, "hbox_status"));
+	gtk_widget_show (widget);
+	widget = GTK_WIDGET(gtk_builder_get_object (builder, "hbox_info"));
+	gtk_widget_hide (widget);
+
+	/* set cursor back to normal */
+	window = gtk_widget_get_window (widget);
+	if (progress_status == PK_STATUS_ENUM_FINISHED) {
+		gdk_window_set_cursor (window, NULL);
+	} else {
+		display = gdk_display_get_default ();
+		cursor = gdk_cursor_new_for_display (display, GDK_WATCH);
+		gdk_window_set_cursor (window, cursor);
+	}
+
+	/* set status */
+	widget = GTK_WIDGET(gtk_builder_get_object (builder, "label_status"));
+	if (progress_status == PK_STATUS_ENUM_FINISHED) {
+		gtk_label_set_label (GTK_LABEL(widget), "");
+		widget = GTK_WIDGET(gtk_builder_get_object (builder, "image_progress"));
+		gtk_widget_hide (widget);
+
+		widget = GTK_WIDGET(gtk_builder_get_object (builder, "progressbar_progress"));
+		gtk_widget_hide (widget);
+	} else {
+		if (progress_status == PK_STATUS_ENUM_QUERY || progress_status == PK_STATUS_ENUM_SETUP) {
+			/* TRANSLATORS: querying update array */
+			title = _("Getting the list of updates");
+		} else if (progress_status == PK_STATUS_ENUM_WAIT) {
+			title = "";
+		} else {
+			title = gpk_status_enum_to_localised_text (progress_status);
 		}
+		gtk_label_set_label (GTK_LABEL(widget), title);
+		gtk_widget_show (widget);
 
-		valid = gtk_tree_model_iter_next (model, &iter);
+		/* set icon */
+		widget = GTK_WIDGET(gtk_builder_get_object (builder, "image_progress"));
+		gtk_image_set_from_icon_name (GTK_IMAGE(widget), gpk_status_enum_to_icon_name (progress_status), GTK_ICON_SIZE_BUTTON);
+		gtk_widget_show (widget);
 	}
+}
 
-	/* create */
-	if (!ret) {
-		title = g_strdup_printf ("<b>%s</b>",
-					 gpk_update_view_get_info_headers (info));
-		gtk_tree_store_append (array_store_updates, &iter, NULL);
-		gtk_tree_store_set (array_store_updates, &iter,
-				    GPK_UPDATES_COLUMN_TEXT, title,
-				    GPK_UPDATES_COLUMN_ID, NULL,
-				    GPK_UPDATES_COLUMN_INFO, info,
-				    GPK_UPDATES_COLUMN_SELECT, TRUE,
-				    GPK_UPDATES_COLUMN_VISIBLE, FALSE,
-				    GPK_UPDATES_COLUMN_CLICKABLE, FALSE,
-				    GPK_UPDATES_COLUMN_RESTART, PK_RESTART_ENUM_NONE,
-				    GPK_UPDATES_COLUMN_STATUS, PK_INFO_ENUM_UNKNOWN,
-				    GPK_UPDATES_COLUMN_SIZE, 0,
-				    GPK_UPDATES_COLUMN_SIZE_DISPLAY, 0,
-				    GPK_UPDATES_COLUMN_PERCENTAGE, 0,
-				    GPK_UPDATES_COLUMN_PULSE, -1,
-				    -1);
-		*parent = iter;
+static void
+gpk_update_viewer_progress_flush_item (GtkTreeModel *model,
+				       const gchar *package_id,
+				       gint percentage)
+{
+	GtkTreeIter iter;
+	guint64 size;
+	guint size_display;
+	g_autoptr(GtkTreePath) path = NULL;
+
+	path = gpk_update_viewer_model_get_path (model, package_id);
+	if (path == NULL) {
+		g_debug ("not found ID for %s", package_id);
+		return;
+	}
+	gtk_tree_model_get_iter (model, &iter, path);
+	gtk_tree_model_get (model, &iter,
+			    GPK_UPDATES_COLUMN_SIZE, &size,
+			    -1);
+	size_display = MIN (size - ((size * percentage) / 100), G_MAXUINT);
+	gtk_tree_store_set (array_store_updates, &iter,
+			    GPK_UPDATES_COLUMN_PERCENTAGE, percentage,
+			    GPK_UPDATES_COLUMN_SIZE_DISPLAY, size_display,
+			    -1);
+}
+
+static void
+gpk_update_viewer_progress_flush (void)
+{
+	GHashTableIter hash_iter;
+	GtkTreeModel *model;
+	GtkTreeView *treeview;
+	GtkWidget *widget;
+	gpointer key;
+	gpointer value;
+
+	treeview = GTK_TREE_VIEW(gtk_builder_get_object (builder, "treeview_updates"));
+	model = gtk_tree_view_get_model (treeview);
+
+	/* only the newest state of each item is drawn */
+	g_hash_table_iter_init (&hash_iter, progress_items);
+	while (g_hash_table_iter_next (&hash_iter, &key, &value))
+		gpk_update_viewer_progress_flush_item (model, key, GPOINTER_TO_INT (value));
+	g_hash_table_remove_all (progress_items);
+
+	if (progress_percentage_pending) {
+		widget = GTK_WIDGET(gtk_builder_get_object (builder, "progressbar_progress"));
+		gtk_widget_show (widget);
+		if (progress_percentage != -1)
+			gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (widget), (gfloat) progress_percentage / 100.0);
+		progress_percentage_pending = FALSE;
+	}
+
+	/* after the percentage, so a finished status can hide the bar */
+	if (progress_status_pending) {
+		gpk_update_viewer_progress_flush_status ();
+		progress_status_pending = FALSE;
+	}
+
+	/* scroll to the active cell */
+	if (progress_scroll_id != NULL) {
+		g_autoptr(GtkTreePath) path = NULL;
+		path = gpk_update_viewer_model_get_path (model, progress_scroll_id);
+		if (path != NULL) {
+			gtk_tree_view_scroll_to_cell (treeview, path,
+						      gtk_tree_view_get_column (treeview, 3),
+						      FALSE, 0.0f, 0.0f);
+		}
+		g_clear_pointer (&progress_scroll_id, g_free);
+	}
+}
+
+static gboolean
+gpk_update_viewer_progress_tick_cb (GtkWidget *widget,
+				    GdkFrameClock *frame_clock,
+				    gpointer user_data)
+{
+	progress_tick_id = 0;
+	gpk_update_viewer_progress_flush ();
+	return G_SOURCE_REMOVE;
+}
+
+static void
+gpk_update_viewer_progress_queue (void)
+{
+	GtkWidget *widget;
+
+	/* progress can arrive far faster than we can draw, so only the
+	 * latest state is written to the widgets once per frame */
+	if (progress_tick_id != 0)
+		return;
+	widget = GTK_WIDGET(gtk_builder_get_object (builder, "treeview_updates"));
+	progress_tick_id = gtk_widget_add_tick_callback (widget,
+							 gpk_update_viewer_progress_tick_cb,
+							 NULL, NULL);
+}
+
+/* the transaction is done, so show its last progress before the panes change */
+static void
+gpk_update_viewer_progress_sync (void)
+{
+	GtkWidget *widget;
+
+	if (progress_tick_id != 0) {
+		widget = GTK_WIDGET(gtk_builder_get_object (builder, "treeview_updates"));
+		gtk_widget_remove_tick_callback (widget, progress_tick_id);
+		progress_tick_id = 0;
 	}
+	gpk_update_viewer_progress_flush ();
 }
 
 static void
@@ -743,7 +1008,6 @@ gpk_update_viewer_progress_cb (PkProgress *progress,
 	gboolean allow_cancel;
 	g_autoptr(PkPackage) package = NULL;
 	gint percentage;
-	GtkWidget *widget;
 	guint64 transaction_flags;
 	PkInfoEnum info;
 	PkRoleEnum role;
@@ -765,9 +1029,7 @@ gpk_update_viewer_progress_cb (PkProgress *progress,
 		GtkTreeView *treeview;
 		GtkTreeIter iter;
 		GtkTreeModel *model;
-		GtkTreeViewColumn *column;
 		GtkTreePath *path;
-		gboolean scroll;
 
 		/* ignore simulation phase */
 		if (pk_bitfield_contain (transaction_flags, PK_TRANSACTION_FLAG_ENUM_SIMULATE))
@@ -788,15 +1050,12 @@ gpk_update_viewer_progress_cb (PkProgress *progress,
 		model = gtk_tree_view_get_model (treeview);
 
 		/* enable or disable the correct spinners */
-		if (role == PK_ROLE_ENUM_UPDATE_PACKAGES) {
-			path = gpk_update_viewer_model_get_path (model, package_id);
-			if (path != NULL) {
-				if (info == PK_INFO_ENUM_FINISHED)
-					gpk_update_viewer_remove_active_row (model, path);
-				else
-					gpk_update_viewer_add_active_row (model, path);
-			}
-			gtk_tree_path_free (path);
+		if (role == PK_ROLE_ENUM_UPDATE_PACKAGES &&
+		    g_hash_table_contains (package_id_rows, package_id)) {
+			if (info == PK_INFO_ENUM_FINISHED)
+				gpk_update_viewer_remove_active_row (model, package_id);
+			else
+				gpk_update_viewer_add_active_row (package_id);
 		}
 
 		/* used for progress */
@@ -826,11 +1085,12 @@ gpk_update_viewer_progress_cb (PkProgress *progress,
 					    GPK_UPDATES_COLUMN_CLICKABLE, FALSE,
 					    GPK_UPDATES_COLUMN_RESTART, PK_RESTART_ENUM_NONE,
 					    GPK_UPDATES_COLUMN_STATUS, PK_INFO_ENUM_UNKNOWN,
-					    GPK_UPDATES_COLUMN_SIZE, 0,
+					    GPK_UPDATES_COLUMN_SIZE, (guint64) 0,
 					    GPK_UPDATES_COLUMN_SIZE_DISPLAY, 0,
 					    GPK_UPDATES_COLUMN_PERCENTAGE, 0,
-					    GPK_UPDATES_COLUMN_PULSE, -1,
 					    -1);
+			gpk_update_viewer_totals_adjust (0, PK_RESTART_ENUM_NONE, TRUE);
+			gpk_update_viewer_model_add_row (&iter, package_id);
 			path = gpk_update_viewer_model_get_path (model, package_id);
 			if (path == NULL) {
 				g_warning ("found no package %s", package_id);
@@ -841,17 +1101,14 @@ gpk_update_viewer_progress_cb (PkProgress *progress,
 		gtk_tree_model_get_iter (model, &iter, path);
 
 		/* if we are adding deps, then select the checkbox */
-		if (role == PK_ROLE_ENUM_UPDATE_PACKAGES) {
-			gtk_tree_store_set (array_store_updates, &iter,
-					    GPK_UPDATES_COLUMN_SELECT, TRUE,
-					    -1);
-		}
-
-		/* scroll to the active cell */
-		scroll = g_settings_get_boolean (settings, GPK_SETTINGS_SCROLL_ACTIVE);
-		if (scroll) {
-			column = gtk_tree_view_get_column (treeview, 3);
-			gtk_tree_view_scroll_to_cell (treeview, path, column, FALSE, 0.0f, 0.0f);
+		if (role == PK_ROLE_ENUM_UPDATE_PACKAGES)
+			gpk_update_viewer_set_selected (&iter, TRUE);
+
+		/* scroll to the active cell on the next frame */
+		if (scroll_active) {
+			g_free (progress_scroll_id);
+			progress_scroll_id = g_strdup (package_id);
+			gpk_update_viewer_progress_queue ();
 		}
 
 		/* only change the status when we're doing the actual update */
@@ -859,6 +1116,7 @@ gpk_update_viewer_progress_cb (PkProgress *progress,
 			/* if the info is finished, change the status to past tense */
 			if (info == PK_INFO_ENUM_FINISHED) {
 				/* clear the remaining size */
+				g_hash_table_remove (progress_items, package_id);
 				gtk_tree_store_set (array_store_updates, &iter,
 						    GPK_UPDATES_COLUMN_SIZE_DISPLAY, 0, -1);
 
@@ -876,71 +1134,19 @@ gpk_update_viewer_progress_cb (PkProgress *progress,
 
 	} else if (type == PK_PROGRESS_TYPE_STATUS) {
 
-		GdkWindow *window;
-		const gchar *title;
-		GdkDisplay *display;
-		g_autoptr(GdkCursor) cursor = NULL;
-
 		g_debug ("status %s", pk_status_enum_to_string (status));
-
-		/* use correct status pane */
-		widget = GTK_WIDGET(gtk_builder_get_object (builder, "hbox_status"));
-		gtk_widget_show (widget);
-		widget = GTK_WIDGET(gtk_builder_get_object (builder, "hbox_info"));
-		gtk_widget_hide (widget);
-
-		/* set cursor back to normal */
-		window = gtk_widget_get_window (widget);
-		if (status == PK_STATUS_ENUM_FINISHED) {
-			gdk_window_set_cursor (window, NULL);
-		} else {
-			display = gdk_display_get_default ();
-			cursor = gdk_cursor_new_for_display (display, GDK_WATCH);
-			gdk_window_set_cursor (window, cursor);
-		}
-
-		/* set status */
-		widget = GTK_WIDGET(gtk_builder_get_object (builder, "label_status"));
-		if (status == PK_STATUS_ENUM_FINISHED) {
-			gtk_label_set_label (GTK_LABEL(widget), "");
-			widget = GTK_WIDGET(gtk_builder_get_object (builder, "image_progress"));
-			gtk_widget_hide (widget);
-
-			widget = GTK_WIDGET(gtk_builder_get_object (builder, "progressbar_progress"));
-			gtk_widget_hide (widget);
-		} else {
-			if (status == PK_STATUS_ENUM_QUERY || status == PK_STATUS_ENUM_SETUP) {
-				/* TRANSLATORS: querying update array */
-				title = _("Getting the list of updates");
-			} else if (status == PK_STATUS_ENUM_WAIT) {
-				title = "";
-			} else {
-				title = gpk_status_enum_to_localised_text (status);
-			}
-			gtk_label_set_label (GTK_LABEL(widget), title);
-			gtk_widget_show (widget);
-
-			/* set icon */
-			widget = GTK_WIDGET(gtk_builder_get_object (builder, "image_progress"));
-			gtk_image_set_from_icon_name (GTK_IMAGE(widget), gpk_status_enum_to_icon_name (status), GTK_ICON_SIZE_BUTTON);
-			gtk_widget_show (widget);
-		}
+		progress_status = status;
+		progress_status_pending = TRUE;
+		gpk_update_viewer_progress_queue ();
 
 	} else if (type == PK_PROGRESS_TYPE_PERCENTAGE) {
 
-		widget = GTK_WIDGET(gtk_builder_get_object (builder, "progressbar_progress"));
-		gtk_widget_show (widget);
-		if (percentage != -1)
-			gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (widget), (gfloat) percentage / 100.0);
+		progress_percentage = percentage;
+		progress_percentage_pending = TRUE;
+		gpk_update_viewer_progress_queue ();
 
 	} else if (type == PK_PROGRESS_TYPE_ITEM_PROGRESS) {
 
-		GtkTreeView *treeview;
-		GtkTreeModel *model;
-		GtkTreeIter iter;
-		GtkTreePath *path;
-		guint size;
-		guint size_display;
 		PkItemProgress *item_progress;
 
 		/* ignore simulation phase */
@@ -950,30 +1156,14 @@ gpk_update_viewer_progress_cb (PkProgress *progress,
 		g_object_get (progress,
 			      "item-progress", &item_progress,
 			      NULL);
-
-		treeview = GTK_TREE_VIEW(gtk_builder_get_object (builder, "treeview_updates"));
-		model = gtk_tree_view_get_model (treeview);
-		path = gpk_update_viewer_model_get_path (model,
-							 pk_item_progress_get_package_id (item_progress));
-		if (path == NULL) {
-			g_debug ("not found ID for %s",
-				 pk_item_progress_get_package_id (item_progress));
-			return;
-		}
-
-		gtk_tree_model_get_iter (model, &iter, path);
-		gtk_tree_model_get (model, &iter,
-				    GPK_UPDATES_COLUMN_SIZE, &size,
-				    -1);
 		percentage = pk_item_progress_get_percentage (item_progress);
 		if (percentage > 0) {
-			size_display = size - ((size * percentage) / 100);
-			gtk_tree_store_set (array_store_updates, &iter,
-					    GPK_UPDATES_COLUMN_PERCENTAGE, percentage,
-					    GPK_UPDATES_COLUMN_SIZE_DISPLAY, size_display,
-					    -1);
+			g_hash_table_insert (progress_items,
+					     g_strdup (pk_item_progress_get_package_id (item_progress)),
+					     GINT_TO_POINTER (percentage));
+			gpk_update_viewer_progress_queue ();
 		}
-		gtk_tree_path_free (path);
+		g_object_unref (item_progress);
 	}
 }
 
@@ -1152,61 +1342,6 @@ gpk_update_viewer_check_mobile_broadband (void)
 	gtk_widget_show (info_mobile);
 }
 
-static void
-gpk_update_viewer_update_global_state_recursive (GtkTreeModel *model, GtkTreeIter *iter)
-{
-	gboolean selected;
-	PkRestartEnum restart;
-	guint size;
-	g_autofree gchar *package_id = NULL;
-	gboolean child_valid;
-	GtkTreeIter child_iter;
-
-	gtk_tree_model_get (model, iter,
-			    GPK_UPDATES_COLUMN_SELECT, &selected,
-			    GPK_UPDATES_COLUMN_RESTART, &restart,
-			    GPK_UPDATES_COLUMN_SIZE, &size,
-			    GPK_UPDATES_COLUMN_ID, &package_id,
-			    -1);
-	if (selected && package_id != NULL) {
-		size_total += size;
-		number_total++;
-		if (restart > restart_worst)
-			restart_worst = restart;
-	}
-
-	/* child entries */
-	child_valid = gtk_tree_model_iter_children (model, &child_iter, iter);
-	while (child_valid) {
-		gpk_update_viewer_update_global_state_recursive (model, &child_iter);
-		child_valid = gtk_tree_model_iter_next (model, &child_iter);
-	}
-}
-
-static void
-gpk_update_viewer_update_global_state (void)
-{
-	gboolean valid;
-	GtkTreeIter iter;
-	GtkTreeView *treeview;
-	GtkTreeModel *model;
-
-	/* reset to zero */
-	size_total = 0;
-	number_total = 0;
-	restart_worst = PK_RESTART_ENUM_NONE;
-
-	treeview = GTK_TREE_VIEW(gtk_builder_get_object (builder, "treeview_updates"));
-	model = gtk_tree_view_get_model (treeview);
-
-	/* if there are no entries selected, deselect the button */
-	valid = gtk_tree_model_get_iter_first (model, &iter);
-	while (valid) {
-		gpk_update_viewer_update_global_state_recursive (model, &iter);
-		valid = gtk_tree_model_iter_next (model, &iter);
-	}
-}
-
 static void
 gpk_update_viewer_modal_error_with_timeout (const gchar *title, const gchar *message)
 {
@@ -1263,8 +1398,8 @@ gpk_update_viewer_reconsider_info (void)
 	g_autofree gchar *text_markup = NULL;
 	PkNetworkEnum state;
 
-	/* update global state */
-	gpk_update_viewer_update_global_state ();
+	/* nothing queued can show the status pane again */
+	gpk_update_viewer_progress_sync ();
 
 	/* get network state */
 	g_object_get (control,
@@ -1392,13 +1527,12 @@ gpk_update_viewer_treeview_update_toggled (GtkCellRendererToggle *cell, gchar *p
 	g_debug ("update %s[%i]", package_id, update);
 
 	/* set new value */
-	gtk_tree_store_set (GTK_TREE_STORE(model), &iter, GPK_UPDATES_COLUMN_SELECT, update, -1);
+	gpk_update_viewer_set_selected (&iter, update);
 
 	/* do the same for any children */
 	child_valid = gtk_tree_model_iter_children (model, &child_iter, &iter);
 	while (child_valid) {
-		gtk_tree_store_set (GTK_TREE_STORE(model), &child_iter,
-				    GPK_UPDATES_COLUMN_SELECT, update, -1);
+		gpk_update_viewer_set_selected (&child_iter, update);
 		child_valid = gtk_tree_model_iter_next (model, &child_iter);
 	}
 
@@ -1553,7 +1687,9 @@ gpk_update_viewer_treeview_add_columns_update (GtkTreeView *treeview)
 	renderer = gtk_cell_renderer_spinner_new ();
 	g_object_set (renderer, "size", GTK_ICON_SIZE_BUTTON, NULL);
 	gtk_tree_view_column_pack_start (column, renderer, TRUE);
-	gtk_tree_view_column_add_attribute (column, renderer, "pulse", GPK_UPDATES_COLUMN_PULSE);
+	gtk_tree_view_column_set_cell_data_func (column, renderer,
+						 gpk_update_viewer_active_row_data_func,
+						 NULL, NULL);
 	gtk_tree_view_column_set_expand (GTK_TREE_VIEW_COLUMN (column), FALSE);
 
 	gtk_tree_view_append_column (treeview, column);
@@ -1857,6 +1993,7 @@ gpk_update_viewer_get_details_cb (PkClient *client, GAsyncResult *res, gpointer
 
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
+	gpk_update_viewer_progress_sync ();
 	if (results == NULL) {
 		/* TRANSLATORS: the PackageKit request did not complete, and it did not send an error */
 		gpk_update_viewer_error_dialog (_("Could not get update details"), NULL, error->message);
@@ -1903,9 +2040,8 @@ gpk_update_viewer_get_details_cb (PkClient *client, GAsyncResult *res, gpointer
 			gtk_tree_path_free (path);
 			gtk_tree_store_set (array_store_updates, &iter,
 					    GPK_UPDATES_COLUMN_DETAILS_OBJ, (gpointer) g_object_ref (item),
-					    GPK_UPDATES_COLUMN_SIZE, (gint)size,
-					    GPK_UPDATES_COLUMN_SIZE_DISPLAY, (gint)size,
 					    -1);
+			gpk_update_viewer_set_size (&iter, size);
 			/* in cache */
 			if (size == 0)
 				gtk_tree_store_set (array_store_updates, &iter,
@@ -1943,6 +2079,7 @@ gpk_update_viewer_get_update_detail_cb (PkClient *client, GAsyncResult *res, gpo
 
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
+	gpk_update_viewer_progress_sync ();
 	if (results == NULL) {
 		/* TRANSLATORS: the PackageKit request did not complete, and it did not send an error */
 		gpk_update_viewer_error_dialog (_("Could not get update details"), NULL, error->message);
@@ -1989,7 +2126,8 @@ gpk_update_viewer_get_update_detail_cb (PkClient *client, GAsyncResult *res, gpo
 			gtk_tree_path_free (path);
 			gtk_tree_store_set (array_store_updates, &iter,
 					    GPK_UPDATES_COLUMN_UPDATE_DETAIL_OBJ, (gpointer) g_object_ref (item),
-					    GPK_UPDATES_COLUMN_RESTART, restart, -1);
+					    -1);
+			gpk_update_viewer_set_restart (&iter, restart);
 		}
 	}
 }
@@ -2018,14 +2156,12 @@ gpk_update_viewer_detail_popup_menu_select_all (GtkWidget *menuitem, gpointer us
 	while (valid) {
 		gtk_tree_model_get (model, &iter, GPK_UPDATES_COLUMN_INFO, &info, -1);
 		if (info != PK_INFO_ENUM_BLOCKED)
-			gtk_tree_store_set (GTK_TREE_STORE(model), &iter,
-					    GPK_UPDATES_COLUMN_SELECT, TRUE, -1);
+			gpk_update_viewer_set_selected (&iter, TRUE);
 
 		/* do for children too */
 		child_valid = gtk_tree_model_iter_children (model, &child_iter, &iter);
 		while (child_valid) {
-			gtk_tree_store_set (GTK_TREE_STORE(model), &child_iter,
-					    GPK_UPDATES_COLUMN_SELECT, TRUE, -1);
+			gpk_update_viewer_set_selected (&child_iter, TRUE);
 			child_valid = gtk_tree_model_iter_next (model, &child_iter);
 		}
 
@@ -2055,16 +2191,14 @@ gpk_update_viewer_detail_popup_menu_select_security (GtkWidget *menuitem, gpoint
 	while (valid) {
 		gtk_tree_model_get (model, &iter, GPK_UPDATES_COLUMN_INFO, &info, -1);
 		ret = (info == PK_INFO_ENUM_SECURITY);
-		gtk_tree_store_set (GTK_TREE_STORE(model), &iter,
-				    GPK_UPDATES_COLUMN_SELECT, ret, -1);
+		gpk_update_viewer_set_selected (&iter, ret);
 
 		/* do for children too */
 		child_valid = gtk_tree_model_iter_children (model, &child_iter, &iter);
 		while (child_valid) {
 			gtk_tree_model_get (model, &child_iter, GPK_UPDATES_COLUMN_INFO, &info, -1);
 			ret = (info == PK_INFO_ENUM_SECURITY);
-			gtk_tree_store_set (GTK_TREE_STORE(model), &child_iter,
-					    GPK_UPDATES_COLUMN_SELECT, ret, -1);
+			gpk_update_viewer_set_selected (&child_iter, ret);
 			child_valid = gtk_tree_model_iter_next (model, &child_iter);
 		}
 
@@ -2090,15 +2224,12 @@ gpk_update_viewer_detail_popup_menu_select_none (GtkWidget *menuitem, gpointer u
 	model = gtk_tree_view_get_model (treeview);
 	valid = gtk_tree_model_get_iter_first (model, &iter);
 	while (valid) {
-		gtk_tree_model_get (model, &iter, -1);
-		gtk_tree_store_set (GTK_TREE_STORE(model), &iter,
-				    GPK_UPDATES_COLUMN_SELECT, FALSE, -1);
+		gpk_update_viewer_set_selected (&iter, FALSE);
 
 		/* do for children too */
 		child_valid = gtk_tree_model_iter_children (model, &child_iter, &iter);
 		while (child_valid) {
-			gtk_tree_store_set (GTK_TREE_STORE(model), &child_iter,
-					    GPK_UPDATES_COLUMN_SELECT, FALSE, -1);
+			gpk_update_viewer_set_selected (&child_iter, FALSE);
 			child_valid = gtk_tree_model_iter_next (model, &child_iter);
 		}
 
@@ -2286,6 +2417,7 @@ gpk_update_viewer_get_updates_cb (PkClient *client, GAsyncResult *res, gpointer
 
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
+	gpk_update_viewer_progress_sync ();
 	if (results == NULL) {
 		/* TRANSLATORS: the PackageKit request did not complete, and it did not send an error */
 		gpk_update_viewer_error_dialog (_("Could not get updates"), NULL, error->message);
@@ -2351,11 +2483,13 @@ gpk_update_viewer_get_updates_cb (PkClient *client, GAsyncResult *res, gpointer
 				    GPK_UPDATES_COLUMN_CLICKABLE, selected,
 				    GPK_UPDATES_COLUMN_RESTART, PK_RESTART_ENUM_NONE,
 				    GPK_UPDATES_COLUMN_STATUS, PK_INFO_ENUM_UNKNOWN,
-				    GPK_UPDATES_COLUMN_SIZE, 0,
+				    GPK_UPDATES_COLUMN_SIZE, (guint64) 0,
 				    GPK_UPDATES_COLUMN_SIZE_DISPLAY, 0,
 				    GPK_UPDATES_COLUMN_PERCENTAGE, 0,
-				    GPK_UPDATES_COLUMN_PULSE, -1,
 				    -1);
+		if (selected)
+			gpk_update_viewer_totals_adjust (0, PK_RESTART_ENUM_NONE, TRUE);
+		gpk_update_viewer_model_add_row (&iter, package_id);
 	}
 
 	/* get the download sizes */
@@ -2404,7 +2538,7 @@ gpk_update_viewer_get_new_update_array (void)
 	PkBitfield filter = PK_FILTER_ENUM_NONE;
 
 	/* clear all widgets */
-	gtk_tree_store_clear (array_store_updates);
+	gpk_update_viewer_model_clear ();
 	gtk_text_buffer_set_text (text_buffer, "", -1);
 
 	widget = GTK_WIDGET(gtk_builder_get_object (builder, "label_header_title"));
@@ -2647,6 +2781,7 @@ gpk_update_viewer_get_distro_upgrades_cb (PkClient *client, GAsyncResult *res, g
 
 	/* get the results */
 	results = pk_client_generic_finish (client, res, &error);
+	gpk_update_viewer_progress_sync ();
 	if (results == NULL) {
 		/* TRANSLATORS: the PackageKit request did not complete, and it did not send an error */
 		gpk_update_viewer_error_dialog (_("Could not get list of distribution upgrades"), NULL, error->message);
@@ -2747,11 +2882,16 @@ gpk_update_viewer_application_startup_cb (GtkApplication *_application, gpointer
 	g_autoptr(GError) error = NULL;
 
 	auto_shutdown_id = 0;
-	size_total = 0;
+	gpk_update_viewer_totals_reset ();
 	ignore_updates_changed = FALSE;
 	restart_update = PK_RESTART_ENUM_NONE;
 
 	settings = g_settings_new (GPK_SETTINGS_SCHEMA);
+	g_signal_connect (settings, "changed",
+			  G_CALLBACK (gpk_update_viewer_settings_changed_cb), NULL);
+	scroll_active = g_settings_get_boolean (settings, GPK_SETTINGS_SCROLL_ACTIVE);
+	progress_items = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	active_rows = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 #ifdef HAVE_SYSTEMD
 	proxy = systemd_proxy_new ();
 #endif
@@ -2793,8 +2933,10 @@ gpk_update_viewer_application_startup_cb (GtkApplication *_application, gpointer
 	/* create array stores */
 	array_store_updates = gtk_tree_store_new (GPK_UPDATES_COLUMN_LAST, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_INT,
 						 G_TYPE_BOOLEAN, G_TYPE_BOOLEAN, G_TYPE_BOOLEAN,
-						 G_TYPE_UINT, G_TYPE_UINT, G_TYPE_UINT, G_TYPE_UINT,
-						 G_TYPE_UINT, G_TYPE_POINTER, G_TYPE_POINTER, G_TYPE_INT, G_TYPE_BOOLEAN);
+						 G_TYPE_UINT, G_TYPE_UINT64, G_TYPE_UINT, G_TYPE_UINT,
+						 G_TYPE_UINT, G_TYPE_POINTER, G_TYPE_POINTER, G_TYPE_BOOLEAN);
+	package_id_rows = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+						 (GDestroyNotify) gtk_tree_row_reference_free);
 	text_buffer = gtk_text_buffer_new (NULL);
 	gtk_text_buffer_create_tag (text_buffer, "para",
 				    "pixels_above_lines", 5,
@@ -2970,6 +3112,13 @@ main (int argc, char *argv[])
 	if (update_array != NULL)
 		g_ptr_array_unref (update_array);
 	g_free (package_id_last);
+	if (package_id_rows != NULL)
+		g_hash_table_unref (package_id_rows);
+	if (progress_items != NULL)
+		g_hash_table_unref (progress_items);
+	if (active_rows != NULL)
+		g_hash_table_unref (active_rows);
+	g_free (progress_scroll_id);
 	if (array_store_updates != NULL)
 		g_object_unref (array_store_updates);
 	if (builder != NULL)